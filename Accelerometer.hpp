@@ -20,6 +20,10 @@
 #ifndef _ACCELEROMETER_HPP_
 #define _ACCELEROMETER_HPP_
 
+// Readings averaged per axis to reduce noise. A power of two, so the
+// average is a shift.
+#define ACCEL_SAMPLES 8
+
 class Axis {
   public:
     Axis(int pin, int rawMin, int rawMax) {
@@ -28,20 +32,22 @@ class Axis {
       this->rawMax = rawMax;
     }
 
-    // Take multiple samples to reduce noise
-    const int sampleSize = 10;
-
     float readAcceleration() {
-      long reading = 0;
+      return readMilliG() / 1000.0;
+    }
+
+    // Each read takes about 104 us on the ADC. The first after switching
+    // pins is thrown away, which gives the sample and hold time to settle on
+    // the new one, so no further wait is needed.
+    int readMilliG() {
+      uint16_t reading = 0;
       analogRead(pin);
-      delay(1);
-      for (int i = 0; i < sampleSize; i++)
+      for (byte i = 0; i < ACCEL_SAMPLES; i++)
       {
         reading += analogRead(pin);
       }
-      int rawReading = reading / sampleSize;
-      long scaled = map(rawReading, rawMin, rawMax, -1000, 1000);
-      return scaled / 1000.0;
+      int rawReading = reading / ACCEL_SAMPLES;
+      return map(rawReading, rawMin, rawMax, -1000, 1000);
     }
 
   protected:
@@ -66,6 +72,16 @@ class Accelerometer {
       return zAxis.readAcceleration();
     }
 
+    int readXMilliG() {
+      return xAxis.readMilliG();
+    }
+    int readYMilliG() {
+      return yAxis.readMilliG();
+    }
+    int readZMilliG() {
+      return zAxis.readMilliG();
+    }
+
   protected:
     Axis& xAxis;
     Axis& yAxis;
@@ -0,0 +1,306 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _AUTOPLAYER_HPP_
+#define _AUTOPLAYER_HPP_
+
+#include "BoardController.hpp"
+#include "InputProvider.hpp"
+#include "TiltEstimator.hpp"
+
+// Tilt used to get the ball rolling, in radians. Anything under the
+// physics' dead zone lets it slow down.
+#define AUTOPLAY_TILT 0.15
+
+// Fastest the ball is rolled, in cells per physics step. Near the end of a
+// move it's rolled at no more than AUTOPLAY_APPROACH times its distance
+// from the middle of the last cell, so it can't overshoot.
+#define AUTOPLAY_SPEED 0.06
+#define AUTOPLAY_APPROACH 0.5
+
+// Change in the real tilt, in radians, that hands the board back to the
+// player
+#define AUTOPLAY_HANDBACK_TILT 0.1
+
+// Millis a demo can run before the next one starts, in case the ball went
+// astray
+#define AUTOPLAY_DEMO_TIME 60000
+
+// A move is a direction in the top two bits and a count of cells in the
+// bottom six. A move ends where a teleport is entered, and the next one
+// starts from its destination. A demo's moves end with a 0.
+const byte Move_North = 0 << 6;
+const byte Move_East = 1 << 6;
+const byte Move_South = 2 << 6;
+const byte Move_West = 3 << 6;
+
+const byte demo1_moves[] PROGMEM = {
+  Move_North | 3, Move_East | 2, Move_South | 6, Move_West | 2, 0
+};
+
+const byte demo3_moves[] PROGMEM = {
+  Move_North | 2, Move_West | 2, Move_North | 1, Move_West | 1, Move_North | 1, Move_West | 1, Move_North | 2,
+  Move_East | 16, Move_South | 4, Move_West | 3, Move_South | 1, Move_West | 1, Move_South | 1, Move_West | 1, 0
+};
+
+const byte demo4_moves[] PROGMEM = {
+  Move_North | 3, Move_East | 1, Move_North | 4, Move_East | 1, Move_North | 4, Move_East | 2, Move_North | 1,
+  Move_East | 6, Move_South | 1, Move_East | 2, Move_South | 8, Move_West | 6, Move_North | 4, Move_East | 2,
+  Move_East | 2, Move_North | 4, Move_West | 6, Move_South | 8, Move_East | 2, Move_South | 1, Move_East | 6,
+  Move_North | 1, Move_East | 2, Move_North | 4, Move_East | 1, Move_North | 4, Move_East | 1, Move_North | 3, 0
+};
+
+const byte demo5_moves[] PROGMEM = {
+  Move_North | 4, Move_West | 3, Move_South | 2, Move_East | 1, Move_South | 2, Move_West | 2, Move_South | 2,
+  Move_West | 1, Move_South | 3, Move_West | 1, Move_South | 1, Move_West | 1, Move_East | 2, Move_North | 4,
+  Move_East | 2, 0
+};
+
+const byte demo6_moves[] PROGMEM = {
+  Move_West | 1, Move_North | 1, Move_West | 1, Move_North | 1, Move_West | 1, Move_North | 1, Move_West | 1,
+  Move_North | 1, Move_West | 3, Move_South | 2, Move_East | 1, Move_South | 1, Move_East | 1, Move_South | 1,
+  Move_East | 1, Move_East | 1, Move_North | 1, Move_East | 1, Move_North | 1, Move_East | 1, Move_North | 2,
+  Move_West | 2, Move_South | 1, Move_West | 1, Move_South | 1, Move_West | 1, Move_South | 1, Move_West | 1,
+  Move_South | 1, Move_West | 2, 0
+};
+
+const byte demo7_moves[] PROGMEM = {
+  Move_West | 2, Move_South | 4, Move_East | 6, Move_North | 8, Move_West | 2, Move_North | 1, Move_West | 6,
+  Move_South | 1, Move_West | 2, Move_South | 4, Move_West | 1, Move_South | 4, Move_West | 1, Move_South | 3,
+  Move_South | 3, Move_West | 1, Move_South | 4, Move_West | 1, Move_South | 4, Move_West | 2, Move_South | 1,
+  Move_West | 6, Move_North | 1, Move_West | 2, Move_North | 8, Move_East | 6, Move_South | 4, Move_West | 2, 0
+};
+
+const byte demo8_moves[] PROGMEM = {
+  Move_West | 2, Move_South | 2, Move_East | 2, Move_South | 3, Move_East | 2, Move_North | 7, Move_East | 4,
+  Move_South | 2, Move_West | 1, Move_South | 1, Move_West | 1, Move_South | 4, Move_East | 4, Move_South | 1,
+  Move_East | 1, Move_North | 4, Move_East | 2, Move_North | 2, Move_West | 3, Move_North | 2, Move_East | 3,
+  Move_North | 2, Move_West | 2, Move_North | 2, Move_East | 4, Move_South | 2, Move_East | 2, Move_North | 1,
+  Move_East | 3, Move_South | 1, Move_East | 2, Move_North | 2, Move_East | 2, Move_South | 2, Move_East | 2,
+  Move_North | 2, 0
+};
+
+const byte demo9_moves[] PROGMEM = {
+  Move_West | 3, Move_South | 1, Move_West | 2, Move_South | 1, Move_West | 3, Move_North | 2, Move_West | 2,
+  Move_South | 4, Move_East | 2, Move_South | 2, Move_West | 2, Move_South | 2, Move_East | 2, Move_South | 4,
+  Move_East | 4, Move_North | 3, Move_East | 2, Move_South | 2, Move_East | 2, Move_North | 2, Move_East | 1,
+  Move_North | 1, Move_East | 1, Move_North | 4, Move_West | 2, Move_South | 2, 0
+};
+
+const byte demo10_moves[] PROGMEM = {
+  Move_North | 1, Move_East | 16, Move_North | 4, Move_West | 15, Move_North | 1, Move_West | 1, Move_North | 3,
+  Move_East | 2, Move_North | 1, Move_East | 2, Move_South | 1, Move_East | 2, Move_North | 1, Move_East | 2,
+  Move_South | 1, Move_East | 2, Move_North | 1, Move_East | 2, Move_South | 1, Move_East | 2, Move_North | 1,
+  Move_East | 2, Move_South | 1, 0
+};
+
+const byte demo11_moves[] PROGMEM = {
+  Move_North | 2, Move_East | 13, Move_South | 11, 0
+};
+
+// A shortest way from a stored level's start to its exit, avoiding traps
+// and warps. Level 0 is left for the easter egg. Level 2 is left out too:
+// its exit at (16,12) is reached through the door at (16,11), which opens
+// and closes by itself, past the mover sweeping row 10, and the moves
+// can't wait for either.
+struct Demo {
+  byte level;
+  const byte* moves; // In PROGMEM
+};
+
+const Demo demos[] PROGMEM = {
+  { 1, demo1_moves },
+  { 3, demo3_moves },
+  { 4, demo4_moves },
+  { 5, demo5_moves },
+  { 6, demo6_moves },
+  { 7, demo7_moves },
+  { 8, demo8_moves },
+  { 9, demo9_moves },
+  { 10, demo10_moves },
+  { 11, demo11_moves },
+};
+
+const byte DEMO_COUNT = sizeof(demos) / sizeof(demos[0]);
+
+// Plays the stored levels by itself to show off the game while nobody is.
+// It steers the first ball along each demo's moves with the same tilt a
+// player would use, so the balls roll under the real physics. The ball is
+// tilted toward the end of each move until it's going fast enough, and
+// otherwise let go so the physics' damping slows it.
+//
+// The accelerometer is still read every update, so the moment the board
+// is tilted away from how it was sitting, the player can take over.
+//
+// As an input it only steers. Loading levels is left to whoever runs the
+// demos, between calls to BoardController::update(): when demoOver(),
+// nextDemo() moves on.
+class Autoplayer : public InputProvider {
+  public:
+    Autoplayer(BoardController<>& controller, TiltEstimator& sensor)
+      : _controller(controller), _sensor(sensor), _x(0), _y(0), _interrupted(false)
+    {
+    }
+
+    // Starts the first demo, taking the board's current tilt as how it's
+    // being left
+    void start() {
+      _sensor.update();
+      _restX = _sensor.x();
+      _restY = _sensor.y();
+      _interrupted = false;
+
+      playDemo(0, true);
+    }
+
+    // Gives the level's exit back to the game
+    void stop() {
+      _controller.clearExitLevel();
+    }
+
+    // Whether the board has been tilted since start()
+    bool interrupted() {
+      return _interrupted;
+    }
+
+    // The demo is over when its level is, whichever way that happened, or
+    // when it's run too long, in case the ball went astray
+    bool demoOver() {
+      return _controller.levelIndex() != _level || timedOut();
+    }
+
+    // Plays the next demo. Its level was loaded by the last one's exit,
+    // unless the last one didn't make it there.
+    void nextDemo() {
+      playDemo((_demo + 1) % DEMO_COUNT, timedOut());
+    }
+
+    void update() override {
+      _sensor.update();
+      if (fabs(_sensor.x() - _restX) > AUTOPLAY_HANDBACK_TILT || fabs(_sensor.y() - _restY) > AUTOPLAY_HANDBACK_TILT) {
+        _interrupted = true;
+      }
+
+      steer();
+    }
+
+    float x() override {
+      return _x;
+    }
+    float y() override {
+      return _y;
+    }
+
+  protected:
+    bool timedOut() {
+      return cycleTimer.millis() - _demoStartTm > AUTOPLAY_DEMO_TIME;
+    }
+
+    // Starts a demo from the beginning of its level, which is loaded
+    // unless it already is. The level's exit leads to the next demo's.
+    void playDemo(byte demo, bool restart) {
+      _demo = demo;
+      _level = pgm_read_byte(&demos[_demo].level);
+      _next = (const byte*)pgm_read_ptr(&demos[_demo].moves);
+      _demoStartTm = cycleTimer.millis();
+
+      if (restart || _controller.levelIndex() != _level) {
+        _controller.setLevel(_level);
+      }
+      _controller.setExitLevel(pgm_read_byte(&demos[(_demo + 1) % DEMO_COUNT].level));
+
+      const Balls& balls = _controller.balls();
+      _fromX = int(balls.x[0]);
+      _fromY = int(balls.y[0]);
+      nextMove();
+    }
+
+    void nextMove() {
+      _move = pgm_read_byte(_next);
+      if (_move != 0) ++_next;
+    }
+
+    void steer() {
+      _x = 0;
+      _y = 0;
+
+      const Balls& balls = _controller.balls();
+      if (balls.count == 0 || _move == 0) return;
+
+      int8_t dx = direction(_move, Move_East, Move_West);
+      int8_t dy = direction(_move, Move_South, Move_North);
+
+      // Count off the cells the ball has moved into. A cell that isn't
+      // ahead of the last one is a teleport's destination, at the end of
+      // a move.
+      int cellX = int(balls.x[0]);
+      int cellY = int(balls.y[0]);
+      if (cellX != _fromX || cellY != _fromY) {
+        byte remaining = _move & 0x3F;
+        int moved = (cellX - _fromX) * dx + (cellY - _fromY) * dy;
+        if (moved < 1 || moved > remaining) moved = 1;
+
+        _fromX = cellX;
+        _fromY = cellY;
+        _move -= moved;
+        if ((_move & 0x3F) == 0) {
+          nextMove();
+          if (_move == 0) return;
+          dx = direction(_move, Move_East, Move_West);
+          dy = direction(_move, Move_South, Move_North);
+        }
+      }
+
+      // Distance to the middle of the cell the move ends in, and the speed
+      // toward it
+      byte count = _move & 0x3F;
+      float distance = dx ? (_fromX + dx * count + 0.5 - balls.x[0]) * dx : (_fromY + dy * count + 0.5 - balls.y[0]) * dy;
+      float speed = dx ? balls.v_x[0] * dx : balls.v_y[0] * dy;
+
+      if (speed < min(AUTOPLAY_SPEED, distance * AUTOPLAY_APPROACH)) {
+        // The physics rolls the ball against the tilt reading
+        _x = -AUTOPLAY_TILT * dx;
+        _y = -AUTOPLAY_TILT * dy;
+      }
+    }
+
+    // 1 or -1 if the move is in the positive or negative direction of an
+    // axis, otherwise 0
+    static int8_t direction(byte move, byte positive, byte negative) {
+      byte d = move & 0xC0;
+      return d == positive ? 1 : d == negative ? -1 : 0;
+    }
+
+    BoardController<>& _controller;
+    TiltEstimator& _sensor;
+    float _x;
+    float _y;
+    float _restX;
+    float _restY;
+    bool _interrupted;
+    byte _demo;
+    byte _level;
+    const byte* _next; // The demo's next move, in PROGMEM
+    byte _move;        // The move being made, with the cells left in it
+    byte _fromX;       // The cell the ball was last counted in
+    byte _fromY;
+    uint32_t _demoStartTm;
+};
+
+#endif
@@ -0,0 +1,308 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _BENCHMARK_HPP_
+#define _BENCHMARK_HPP_
+
+#include "Autoplayer.hpp"
+#include "BoardController.hpp"
+#include "CycleTimer.hpp"
+#include "SteadyInput.hpp"
+#include "Telemetry.hpp"
+
+// What each Record_Benchmark measured. Results are CPU cycles per call.
+const byte Benchmark_CellAt = 1;      // Level::cellAt() averaged over every cell, argument is the level
+const byte Benchmark_Update = 2;      // BoardController::update() running one step with a steady tilt and no frame
+                                      // shown, argument is the level
+const byte Benchmark_RedrawBoard = 3; // BoardController::redrawBoard(), argument is the level
+                                      // 4 was the plasma screensaver, which attract mode replaced
+const byte Benchmark_Maze = 5;        // MazeLevel::generate(), argument is the seed
+const byte Benchmark_CellTraits = 6;  // One Cell trait lookup averaged over every cell value, argument is 0 for
+                                      // solid(), 1 for event() and 2 for color()
+const byte Benchmark_Attract = 7;     // Cycles in BoardController::update() over a second of attract mode, argument
+                                      // unused. The rest of the second is spent waiting for steps and frames.
+const byte Benchmark_Balls = 8;       // One physics step on level 1, argument is the number of balls in play. Run
+                                      // for 1, 4 and 16 balls, as many as MAX_BALLS allows. Steps that hit a trap
+                                      // aren't counted.
+const byte Benchmark_Draw = 9;        // One pixel drawn, averaged over a frame of every color level, argument is
+                                      // 0 for FrameMatrix at full brightness, 1 for it dimmed to 64, and 2 and 3
+                                      // for the NeoPixel library's own drawing at the same brightnesses
+const byte Benchmark_Brightness = 10; // Dimming a drawn board to 64, argument is 0 for FrameMatrix and 1 for the
+                                      // NeoPixel library
+const byte Benchmark_MazeStep = 11;   // The longest MazeLevel::step(), which loading runs between frames, argument
+                                      // is the seed
+const byte Benchmark_Tilt = 12;       // TiltEstimator::update(), reading all three axes, argument unused. Most of it
+                                      // is waiting on the ADC.
+
+// Measures the sketch's hot paths on the device and reports them as
+// telemetry records, so results can be compared across commits with
+// tools/telemetry.py. `make benchmark` in test/ runs the same code on the
+// host, counting host cycles.
+class Benchmark {
+  public:
+    Benchmark(BoardController<>& controller, FrameMatrix& matrix, LevelSet<>& levels, Autoplayer& autoplayer)
+      : _controller(controller), _matrix(matrix), _levels(levels), _autoplayer(autoplayer)
+    {
+      // Cost of reading the timer itself, taken out of every result
+      uint32_t start = cycleTimer.cycles();
+      _overhead = cycleTimer.cycles() - start;
+    }
+
+    void run() {
+      for (byte level = 0; level < _levels.count; ++level) {
+        benchmarkCellAt(level);
+        benchmarkRedrawBoard(level);
+        benchmarkUpdate(level);
+      }
+      for (byte balls = 1; balls <= min(16, MAX_BALLS); balls *= 4) {
+        benchmarkBalls(balls);
+      }
+      benchmarkAttract();
+      benchmarkCellTraits();
+      benchmarkDraw();
+      benchmarkBrightness();
+      benchmarkTilt();
+      for (byte seed = 1; seed <= 8; ++seed) {
+        benchmarkMaze(seed);
+      }
+    }
+
+  protected:
+    void benchmarkCellAt(byte level) {
+      Level<> l = _levels.level(level);
+
+      uint32_t start = cycleTimer.cycles();
+      for (int x = 0; x < MATRIX_WIDTH; ++x) {
+        for (int y = 0; y < MATRIX_HEIGHT; ++y) {
+          _sink = l.cellAt(x, y);
+        }
+      }
+      uint32_t elapsed = cycleTimer.cycles() - start - _overhead;
+
+      report(Benchmark_CellAt, level, elapsed / (MATRIX_WIDTH * MATRIX_HEIGHT));
+    }
+
+    void benchmarkAttract() {
+      _controller.setInput(_autoplayer);
+      _autoplayer.start();
+
+      uint32_t total = 0;
+      uint32_t startTm = cycleTimer.millis();
+      while (cycleTimer.millis() - startTm < 1000) {
+        uint32_t start = cycleTimer.cycles();
+        _controller.update();
+        total += cycleTimer.cycles() - start - _overhead;
+
+        if (_autoplayer.demoOver()) {
+          _autoplayer.nextDemo();
+        }
+      }
+
+      _autoplayer.stop();
+      _controller.setInput(tilt);
+      report(Benchmark_Attract, 0, total);
+    }
+
+    void benchmarkBalls(byte count) {
+      const int steps = 200;
+
+      // Rolls the balls around the board, a quarter turn every half second
+      const float tilts[4][2] = { { 0.3, 0.1 }, { -0.1, 0.3 }, { -0.3, -0.1 }, { 0.1, -0.3 } };
+
+      byte ballCount = _controller.ballCount();
+      _controller.setBallCount(count);
+      _controller.setLevel(1);
+      byte balls = _controller.balls().count;
+
+      // Steps that hit a trap play its animation, which would swamp the
+      // physics, so they're left out. Level 1 counts its traps, and
+      // clearing the count before each step keeps it from reaching the
+      // easter egg.
+      uint32_t total = 0;
+      int timed = 0;
+      for (int i = 0; i < steps; ++i) {
+        const float* tilt = tilts[(i / 50) % 4];
+
+        _controller.setTrapCount(0);
+        uint32_t start = cycleTimer.cycles();
+        _controller.simulateStep(tilt[0], tilt[1]);
+        uint32_t cycles = cycleTimer.cycles() - start - _overhead;
+        if (_controller.trapCount() == 0) {
+          total += cycles;
+          ++timed;
+        }
+      }
+
+      _controller.setBallCount(ballCount);
+      report(Benchmark_Balls, balls, timed ? total / timed : 0);
+    }
+
+    void benchmarkCellTraits() {
+      uint32_t start = cycleTimer.cycles();
+      for (int cell = 0; cell < 256; ++cell) {
+        _sink = Cell::solid(cell);
+      }
+      report(Benchmark_CellTraits, 0, (cycleTimer.cycles() - start - _overhead) / 256);
+
+      start = cycleTimer.cycles();
+      for (int cell = 0; cell < 256; ++cell) {
+        _sink = Cell::event(cell);
+      }
+      report(Benchmark_CellTraits, 1, (cycleTimer.cycles() - start - _overhead) / 256);
+
+      start = cycleTimer.cycles();
+      for (int cell = 0; cell < 256; ++cell) {
+        _sink = Cell::color(cell);
+      }
+      report(Benchmark_CellTraits, 2, (cycleTimer.cycles() - start - _overhead) / 256);
+    }
+
+    void benchmarkDraw() {
+      const uint8_t brightnesses[2] = { 255, 64 };
+      uint8_t brightness = _matrix.getBrightness();
+
+      for (byte i = 0; i < 2; ++i) {
+        _matrix.setBrightness(brightnesses[i]);
+        report(Benchmark_Draw, i, drawFrame(false));
+
+        // The library scales colors by its own brightness as it draws them,
+        // which FrameMatrix otherwise leaves at full
+        _matrix.Adafruit_NeoPixel::setBrightness(brightnesses[i]);
+        report(Benchmark_Draw, i + 2, drawFrame(true));
+        _matrix.Adafruit_NeoPixel::setBrightness(0);
+      }
+
+      _matrix.setBrightness(brightness);
+      _controller.redrawBoard();
+    }
+
+    // Returns the cycles per pixel of drawing every pixel, each a different
+    // color level
+    uint32_t drawFrame(bool library) {
+      uint32_t start = cycleTimer.cycles();
+      for (int y = 0; y < MATRIX_HEIGHT; ++y) {
+        for (int x = 0; x < MATRIX_WIDTH; ++x) {
+          byte i = y * MATRIX_WIDTH + x;
+          uint16_t color = FrameMatrix::color(i, i * 4, 255 - i);
+          if (library) {
+            _matrix.Adafruit_NeoMatrix::drawPixel(x, y, color);
+          } else {
+            _matrix.drawPixel(x, y, color);
+          }
+        }
+      }
+      return (cycleTimer.cycles() - start - _overhead) / (MATRIX_WIDTH * MATRIX_HEIGHT);
+    }
+
+    void benchmarkBrightness() {
+      uint8_t brightness = _matrix.getBrightness();
+      _controller.setLevel(0);
+
+      _matrix.setBrightness(255);
+      uint32_t start = cycleTimer.cycles();
+      _matrix.setBrightness(64);
+      report(Benchmark_Brightness, 0, cycleTimer.cycles() - start - _overhead);
+
+      _matrix.setBrightness(255);
+      _controller.redrawBoard();
+      start = cycleTimer.cycles();
+      _matrix.Adafruit_NeoPixel::setBrightness(64);
+      report(Benchmark_Brightness, 1, cycleTimer.cycles() - start - _overhead);
+      _matrix.Adafruit_NeoPixel::setBrightness(0);
+
+      _matrix.setBrightness(brightness);
+      _controller.redrawBoard();
+    }
+
+    void benchmarkTilt() {
+      const byte runs = 10;
+
+      uint32_t start = cycleTimer.cycles();
+      for (byte i = 0; i < runs; ++i) {
+        tilt.update();
+      }
+      report(Benchmark_Tilt, 0, (cycleTimer.cycles() - start - _overhead) / runs);
+    }
+
+    void benchmarkRedrawBoard(byte level) {
+      _controller.setLevel(level);
+
+      uint32_t start = cycleTimer.cycles();
+      _controller.redrawBoard();
+      report(Benchmark_RedrawBoard, level, cycleTimer.cycles() - start - _overhead);
+    }
+
+    void benchmarkUpdate(byte level) {
+      const byte runs = 10;
+
+      // The accelerometer's reads would cost more than the step itself
+      SteadyInput input(0.2, 0.1);
+      _controller.setInput(input);
+      _controller.setLevel(level);
+
+      uint32_t total = 0;
+      for (byte i = 0; i < runs; ++i) {
+        // Show a frame now, so none comes due in the timed call, then let
+        // exactly one physics step come due
+        _controller.renderFrame(true);
+        _controller.restartClock();
+        delay(10);
+
+        uint32_t start = cycleTimer.cycles();
+        _controller.update();
+        total += cycleTimer.cycles() - start - _overhead;
+      }
+
+      _controller.setInput(tilt);
+      report(Benchmark_Update, level, total / runs);
+    }
+
+    void benchmarkMaze(byte seed) {
+      MazeLevel<> maze;
+
+      uint32_t start = cycleTimer.cycles();
+      maze.generate(seed);
+      report(Benchmark_Maze, seed, cycleTimer.cycles() - start - _overhead);
+
+      uint32_t longest = 0;
+      maze.begin(seed);
+      bool more = true;
+      while (more) {
+        start = cycleTimer.cycles();
+        more = maze.step();
+        longest = max(longest, cycleTimer.cycles() - start - _overhead);
+      }
+      report(Benchmark_MazeStep, seed, longest);
+    }
+
+    void report(byte id, byte argument, uint32_t cycles) {
+      // Results matter more than staying non-blocking here
+      Serial.flush();
+      telemetry.benchmark(id, argument, cycles);
+    }
+
+    BoardController<>& _controller;
+    FrameMatrix& _matrix;
+    LevelSet<>& _levels;
+    Autoplayer& _autoplayer;
+    uint32_t _overhead;
+    volatile uint16_t _sink; // Keeps the compiler from dropping lookups
+};
+
+#endif
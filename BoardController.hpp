@@ -20,35 +20,112 @@
 #ifndef _BOARDCONTROLLER_HPP_
 #define _BOARDCONTROLLER_HPP_
 
-#include "Accelerometer.hpp"
+#include "CellSet.hpp"
+#include "CellTraits.hpp"
+#include "CycleTimer.hpp"
+#include "DistanceMap.hpp"
 #include "Levels.hpp"
+#include "MazeLevel.hpp"
 #include "PictureFrame.hpp"
+#include "Telemetry.hpp"
+#include "InputProvider.hpp"
 
-struct Ball {
-  int xInt() {
-    return int(x);
+#ifndef MAX_BALLS
+#define MAX_BALLS 4
+#endif
+
+// The balls in play, stored as parallel arrays so the physics loops walk
+// each field contiguously.
+struct Balls {
+  int xInt(byte i) {
+    return int(x[i]);
+  }
+  int yInt(byte i) {
+    return int(y[i]);
+  }
+
+  // Position in 256ths of a cell, for drawing
+  int16_t xFixed(byte i) {
+    return x[i] * 256;
   }
-  int yInt() {
-    return int(y);
+  int16_t yFixed(byte i) {
+    return y[i] * 256;
   }
 
-  float x = 0.0;
-  float y = 0.0;
-  float v_x = 0.0;
-  float v_y = 0.0;
-  const float radius = 0.1;
+  // Remembers where ball i is before a step, so it can be drawn moving
+  // between the two positions
+  void savePosition(byte i) {
+    prevX[i] = xFixed(i);
+    prevY[i] = yFixed(i);
+  }
+
+  float x[MAX_BALLS];
+  float y[MAX_BALLS];
+  float v_x[MAX_BALLS];
+  float v_y[MAX_BALLS];
+  int16_t prevX[MAX_BALLS]; // Position before the last step, in 256ths of a cell
+  int16_t prevY[MAX_BALLS];
+  byte count = 0;
+
+  static constexpr float radius = 0.1;
 };
 
 #define EPSILON 0.000001
+#define NO_BALL 0xFF
+#define NO_ELEMENT 0xFF
+
+// Millis on a level before the hint toward the exit shows
+#define HINT_DELAY 60000
+
+// Cells lit by the hint
+#define HINT_LENGTH 6
 
+// Cells of the hint's search run each time update() has no step to do
+#define HINT_SEARCH_CELLS 16
+
+// The stored levels are followed by an endless run of generated mazes,
+// each generated while the exit animation into it waits between frames.
+// Comment out to go back to level 1 after the last stored level instead,
+// as the board did before there were mazes.
+#define ENDLESS_MAZES
+
+// Millis between frames. The balls are drawn part way between physics
+// steps, so they move smoothly whatever the step period.
+#define FRAME_PERIOD 25
+
+// Uncomment to check the physics invariants after every step, reporting
+// violations over telemetry
+// #define CHECK_INVARIANTS
+
+// Invariants checked by BoardController::checkInvariants()
+const byte Invariant_Bounds = 1;    // Ball outside the board
+const byte Invariant_Solid = 2;     // Ball inside a wall, closed door or mover
+const byte Invariant_Speed = 4;     // Velocity past maxSpeed
+const byte Invariant_Occupancy = 8; // Occupancy map doesn't match the balls
+
+// Plays levels on a board of WIDTH x HEIGHT cells. The size is fixed at
+// compile time so bounds checks and cell index arithmetic use constants.
+template <byte WIDTH = MATRIX_WIDTH, byte HEIGHT = MATRIX_HEIGHT>
 class BoardController {
+  static_assert(WIDTH * HEIGHT <= 256 - Cell_PointerBase, "Teleport cells can't address every cell of the board");
+
   public:
-    BoardController(Adafruit_NeoMatrix& matrix, Accelerometer& accel, LevelSet& levels)
-      : _matrix(matrix), _accel(accel), _levels(levels),
+    BoardController(FrameMatrix& matrix, InputProvider& input, LevelSet<WIDTH, HEIGHT>& levels)
+      : _matrix(matrix), _input(&input), _levels(levels),
         _levelIndex(1),
         _lastUpdateTm(0),
+        _pendingTm(0),
+        _ballCount(1),
+        _ballPixelCount(0),
+        _drawnCount(0),
+        _boardChanged(false),
+        _lastFrameTm(0),
+        _elementSteps(0),
         _trapCount(0),
-        _palette(_matrix)
+        _exitLevel(0),
+        _exitFixed(false),
+        _generating(false),
+        _levelDrawn(false)
     {
     }
 
@@ -57,173 +134,659 @@ class BoardController {
       reset();
     }
 
-    uint32_t nextUpdateTm() {
-      return _lastUpdateTm + PERIOD;
+    void nextLevel() {
+      _trapCount = 0; // Reset the easter egg
+      setLevel(followingLevel());
+    }
+
+    // The level after this one. With ENDLESS_MAZES, the stored levels are
+    // followed by a generated maze for each index after them, which starts
+    // over after the last index. Without, level 0 is skipped when wrapping
+    // around from the last stored level.
+    byte followingLevel() {
+#ifdef ENDLESS_MAZES
+      return _levelIndex == 255 ? _levels.count : _levelIndex + 1;
+#else
+      return max(1, (_levelIndex + 1) % _levels.count);
+#endif
+    }
+
+    byte levelIndex() {
+      return _levelIndex;
+    }
+
+    // Sends the last ball out of any level to the level at index, instead
+    // of the following one, until clearExitLevel()
+    void setExitLevel(byte index) {
+      _exitLevel = index;
+      _exitFixed = true;
+    }
+
+    void clearExitLevel() {
+      _exitFixed = false;
+    }
+
+    // Traps hit on level 1 towards the easter egg
+    byte trapCount() {
+      return _trapCount;
+    }
+
+    void setTrapCount(byte count) {
+      _trapCount = count;
+    }
+
+    // Sets where the tilt comes from, from the next update()
+    void setInput(InputProvider& input) {
+      _input = &input;
+    }
+
+    // The balls in play, for inputs that steer them
+    const Balls& balls() {
+      return _balls;
+    }
+
+    // How many balls each level starts with
+    byte ballCount() {
+      return _ballCount;
+    }
+
+    // Sets how many balls each level starts with, from the next reset()
+    void setBallCount(byte count) {
+      _ballCount = max(1, min(MAX_BALLS, count));
     }
 
     void redrawBoard() {
+      drawBoard();
+      _matrix.show();
+    }
+
+    // Draws the level without the balls, and without showing it
+    void drawBoard() {
       _matrix.clear();
+      _hintLength = 0;
 
-      for (int i = 0; i < _matrix.width(); ++i) {
-        for (int j = 0; j < _matrix.height(); ++j) {
-          _matrix.drawPixel(i, j, _palette.colorForCell(level()->cellAt(i, j)));
+      for (int i = 0; i < WIDTH; ++i) {
+        for (int j = 0; j < HEIGHT; ++j) {
+          _matrix.drawPixel(i, j, colorAt(i, j));
         }
       }
+    }
 
-      _matrix.show();
+    void drawBalls() {
+      renderFrame(true);
     }
 
-    void drawBall() {
-      _matrix.drawPixel(_ball.xInt(), _ball.yInt(), _palette.ballColor());
-      _matrix.show();
+    // Draws the balls where they are between the last two physics steps and
+    // shows the frame. Unless forced, the frame is skipped if nothing on it
+    // has changed.
+    void renderFrame(bool force) {
+      if (drawFrame(force)) {
+        _matrix.show();
+      }
+    }
+
+    // Draws the balls for renderFrame(), returning false if nothing on the
+    // frame has changed and it wasn't forced. Each ball is spread over the
+    // four pixels nearest its position, so it moves smoothly instead of
+    // jumping between cells.
+    bool drawFrame(bool force) {
+      _lastFrameTm = cycleTimer.millis();
+
+      // How far the clock is into the next step, in 256ths of a step
+      long alpha = long(_pendingTm) * 256 / PERIOD;
+
+      bool changed = force || _boardChanged || _balls.count != _drawnCount;
+      for (byte i = 0; i < _balls.count; ++i) {
+        int16_t x = _balls.prevX[i] + ((_balls.xFixed(i) - _balls.prevX[i]) * alpha >> 8);
+        int16_t y = _balls.prevY[i] + ((_balls.yFixed(i) - _balls.prevY[i]) * alpha >> 8);
+        changed |= x != _drawnX[i] || y != _drawnY[i];
+        _drawnX[i] = x;
+        _drawnY[i] = y;
+      }
+      _drawnCount = _balls.count;
+
+      if (!changed) return false;
+
+      // Put back the board under the last frame's balls
+      for (byte k = 0; k < _ballPixelCount; ++k) {
+        int x = _ballPixels[k] % WIDTH;
+        int y = _ballPixels[k] / WIDTH;
+        _matrix.drawPixel(x, y, boardColorAt(x, y));
+      }
+
+      // Where balls overlap their weights add, since they're one color
+      uint16_t weights[4 * MAX_BALLS];
+      _ballPixelCount = 0;
+      for (byte i = 0; i < _balls.count; ++i) {
+        // Pixels are centered in their cells. The offset keeps the values
+        // positive, so shifts round down.
+        int16_t x = _drawnX[i] - 128 + 256;
+        int16_t y = _drawnY[i] - 128 + 256;
+        int px = (x >> 8) - 1;
+        int py = (y >> 8) - 1;
+        uint32_t fx = x & 0xFF;
+        uint32_t fy = y & 0xFF;
+
+        addBallPixel(weights, px, py, (256 - fx) * (256 - fy) >> 8);
+        addBallPixel(weights, px + 1, py, fx * (256 - fy) >> 8);
+        addBallPixel(weights, px, py + 1, (256 - fx) * fy >> 8);
+        addBallPixel(weights, px + 1, py + 1, fx * fy >> 8);
+      }
+
+      for (byte k = 0; k < _ballPixelCount; ++k) {
+        int x = _ballPixels[k] % WIDTH;
+        int y = _ballPixels[k] / WIDTH;
+        uint16_t weight = min(256, weights[k]);
+        _matrix.drawPixel(x, y, FrameMatrix::blend(boardColorAt(x, y), ColorPalette::ballColor(), weight));
+      }
+
+      _boardChanged = false;
+      return true;
+    }
+
+    void addBallPixel(uint16_t* weights, int x, int y, uint16_t weight) {
+      if (weight == 0 || x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT) return;
+
+      byte index = y * WIDTH + x;
+      for (byte k = 0; k < _ballPixelCount; ++k) {
+        if (_ballPixels[k] == index) {
+          weights[k] += weight;
+          return;
+        }
+      }
+      _ballPixels[_ballPixelCount] = index;
+      weights[_ballPixelCount++] = weight;
+    }
+
+    bool frameDue() {
+      return cycleTimer.millis() - _lastFrameTm >= FRAME_PERIOD;
     }
 
     void reset() {
-      redrawBoard();
+      uint32_t start = cycleTimer.micros();
+      beginLoad(_levelIndex);
+      finishLoad();
+      telemetry.transition(_levelIndex, false, cycleTimer.micros() - start);
+    }
+
+    // Leaves the level through the cell at x, y for the level at index. The
+    // new level is loaded, and drawn, while the exit animation waits between
+    // frames, so only showing it is left once the animation ends.
+    void exitTo(byte index, int x, int y) {
+      beginLoad(index);
+      animateExit(x, y);
+
+      uint32_t start = cycleTimer.micros();
+      finishLoad();
+      telemetry.transition(_levelIndex, true, cycleTimer.micros() - start);
+    }
+
+    // Starts loading the level at index, which loadStep() continues. Play
+    // can't go on until finishLoad() is called.
+    void beginLoad(byte index) {
+      _levelIndex = index;
+      _generating = index >= _levels.count;
+      if (_generating) {
+        _maze.begin(index - _levels.count + 1);
+      } else {
+        _level = _levels.level(index);
+        startLevel();
+      }
+
+      _occupied.clear();
+      _balls.count = 0;
+      _loadRow = 0;
+      _levelDrawn = false;
+    }
+
+    // Resets what goes with the level, once it can be read
+    void startLevel() {
+      _distances.begin();
+      resetElements();
+    }
+
+    // Does the next part of loading the level: a part of generating it, for
+    // a maze, then one row of the collision map, then placing the balls,
+    // then the hint's search. Returns false once there's nothing left to do.
+    bool loadStep() {
+      if (_generating) {
+        if (!_maze.step()) {
+          _generating = false;
+          _level = _maze.level();
+          startLevel();
+        }
+        return true;
+      }
 
-      _ball.v_x = 0.0;
-      _ball.v_y = 0.0;
+      if (_loadRow < HEIGHT) {
+        for (int x = 0; x < WIDTH; ++x) {
+          updateSolid(x, _loadRow);
+        }
+        ++_loadRow;
+        return true;
+      }
+
+      if (_loadRow == HEIGHT) {
+        while (_balls.count < _ballCount && spawnBall(_balls.count)) {
+          ++_balls.count;
+        }
+        ++_loadRow;
+        return true;
+      }
+
+      return !_distances.advance(level(), HINT_SEARCH_CELLS);
+    }
+
+    // Shows the level with its balls in a single frame, first loading and
+    // drawing what readyLevel() hasn't
+    void finishLoad() {
+      if (!_levelDrawn) {
+        readyLevel();
+      }
+      _matrix.show();
 
-      _ball.x = level()->startX;
-      _ball.y = level()->startY;
+      _levelStartTm = cycleTimer.millis();
+      telemetry.level(_levelIndex, _balls.count);
 
-      drawBall();
+      restartClock();
+    }
+
+    // Completes whatever loading is needed to play and draws the level with
+    // its balls, to be shown by finishLoad()
+    void readyLevel() {
+      while (_generating || _loadRow <= HEIGHT) {
+        loadStep();
+      }
+
+      drawBoard();
+      drawFrame(true);
+      _levelDrawn = true;
+    }
+
+    // Waits ms, spending the time on loading the level. If ready, the level
+    // is drawn as well, so the wait after an animation's last frame leaves
+    // the level's first ready to show.
+    void idle(uint16_t ms, bool ready = false) {
+      uint32_t start = cycleTimer.millis();
+      while (cycleTimer.millis() - start < ms && loadStep()) {
+      }
+      if (ready) {
+        readyLevel();
+      }
+
+#ifdef MIRROR
+      // The frame's changes go on out as the serial port drains, rather
+      // than only the buffer's worth sent when it was shown. Not once the
+      // next frame is drawn, which would go out as the one shown.
+      while (!ready && cycleTimer.millis() - start < ms) {
+        _matrix.mirror();
+        delay(1);
+      }
+#endif
+
+      uint32_t elapsed = cycleTimer.millis() - start;
+      if (elapsed < ms) {
+        delay(ms - elapsed);
+      }
+    }
+
+    // Places ball i in the free cell nearest the level's start, searching
+    // outward in squares. Returns false if there's no room for it.
+    bool spawnBall(byte i) {
+      const int maxDistance = 3;
+
+      for (int r = 0; r <= maxDistance; ++r) {
+        for (int dy = -r; dy <= r; ++dy) {
+          for (int dx = -r; dx <= r; ++dx) {
+            if (max(abs(dx), abs(dy)) != r) continue; // Inside this square
+
+            int x = level()->startX + dx;
+            int y = level()->startY + dy;
+            if (validLocation(x, y) && !eventCell(x, y) && !_occupied.contains(x, y)) {
+              // Start in the middle of the cell
+              _balls.x[i] = x + 0.5;
+              _balls.y[i] = y + 0.5;
+              _balls.v_x[i] = 0.0;
+              _balls.v_y[i] = 0.0;
+              _balls.savePosition(i);
+              _occupied.add(x, y);
+              return true;
+            }
+          }
+        }
+      }
 
-      _lastUpdateTm = millis();
+      return false;
+    }
+
+    // Takes ball i out of play, moving the last ball into its slot
+    void removeBall(byte i) {
+      _occupied.remove(_balls.xInt(i), _balls.yInt(i));
+
+      byte last = --_balls.count;
+      _balls.x[i] = _balls.x[last];
+      _balls.y[i] = _balls.y[last];
+      _balls.v_x[i] = _balls.v_x[last];
+      _balls.v_y[i] = _balls.v_y[last];
+      _balls.prevX[i] = _balls.prevX[last];
+      _balls.prevY[i] = _balls.prevY[last];
+    }
+
+    // Discards elapsed time that shouldn't be simulated, like the time spent
+    // in a blocking animation.
+    void restartClock() {
+      _lastUpdateTm = cycleTimer.millis();
+      _pendingTm = 0;
     }
 
     // Returns true if anything on the board changed, false otherwise
     bool update() {
-      if (millis() < nextUpdateTm()) {
+      // Measure the real time since the last call, on the clock that keeps
+      // counting while show() has interrupts off. Unsigned subtraction stays
+      // correct when it wraps around.
+      uint32_t now = cycleTimer.millis();
+      _pendingTm += now - _lastUpdateTm;
+      _lastUpdateTm = now;
+
+      if (_pendingTm < PERIOD) {
+        if (frameDue()) {
+          renderFrame(false);
+        } else {
+          // Spend the idle time on the hint's search
+          _distances.advance(level(), HINT_SEARCH_CELLS);
+        }
         return false;
       }
 
-      int startingX = _ball.xInt();
-      int startingY = _ball.yInt();
+      uint32_t startMicros = cycleTimer.micros();
 
-      updateBallPosition();
+      // If we've fallen far behind, drop the backlog instead of simulating it,
+      // which would only make the next call later still.
+      if (_pendingTm > MAX_STEPS * PERIOD) {
+        _pendingTm = MAX_STEPS * PERIOD;
+      }
 
-      updateBallVelocity();
+      // Sampling is slow, so one reading is shared by all the steps
+      _input->update();
+      float xAccel = -1.0 * _input->x();
+      float yAccel = -1.0 * _input->y();
+      telemetry.sensors(xAccel, yAccel);
 
-      // If the ball's position has moved across cell boundaries, update the board
+      // Advance the simulation in fixed steps so the balls move the same way
+      // however long each call took. Events that interrupt play restart the
+      // clock, which ends the loop.
       bool changed = false;
+      byte steps = 0;
+      while (_pendingTm >= PERIOD) {
+        _pendingTm -= PERIOD;
+        ++steps;
 
-      if ((_ball.xInt() != startingX || _ball.yInt() != startingY)) {
-        changed = true;
+        changed |= simulateStep(xAccel, yAccel);
 
-        _matrix.drawPixel(startingX, startingY, _palette.colorForCell(level()->cellAt(startingX, startingY)));
-        _matrix.show();
+#ifdef CHECK_INVARIANTS
+        checkInvariants();
+#endif
+      }
 
-        byte newCell = level()->cellAt(_ball.xInt(), _ball.yInt());
+      changed |= updateHint();
 
-        if (newCell >= Cell_PointerBase) {
-          _matrix.drawPixel(startingX, startingY, _palette.colorForCell(level()->cellAt(startingX, startingY)));
+      // Changes to the board are drawn without showing them, and wait for
+      // the next frame
+      _boardChanged |= changed;
+      if (frameDue()) {
+        renderFrame(false);
+      }
 
-          byte destination = newCell - Cell_PointerBase;
-          byte row = destination / _matrix.width();
-          byte col = destination % _matrix.width();
+      for (byte i = 0; i < _balls.count; ++i) {
+        telemetry.ball(i, _balls.x[i], _balls.y[i], _balls.v_x[i], _balls.v_y[i]);
+      }
+      telemetry.timing(cycleTimer.micros() - startMicros, steps, _matrix.frameMilliamps());
+
+      return changed;
+    }
+
+    // Advances every ball and the level's elements by one fixed step.
+    // Returns true if anything on the board changed.
+    bool simulateStep(float xAccel, float yAccel) {
+      bool changed = false;
 
-          animateTeleport(_ball.xInt(), _ball.yInt(), col, row);
+      for (byte i = 0; i < _balls.count; ++i) {
+        _balls.savePosition(i);
+      }
 
-          _ball.x = float(col);
-          _ball.y = float(row);
-          _ball.v_x = 0.0;
-          _ball.v_y = 0.0;
+      for (byte i = 0; i < _balls.count; ) {
+        StepResult result = step(i, xAccel, yAccel);
+        if (result != Step_Unchanged) {
+          changed = true;
+        }
+        if (result == Step_Reset) {
+          return true;
+        } else if (result != Step_Removed) {
+          ++i;
+        }
+      }
 
-          drawBall();
+      if (++_elementSteps * PERIOD >= ELEMENT_TICK) {
+        _elementSteps = 0;
+        changed |= tickElements();
+      }
 
-        } else if (newCell >= Cell_WarpBase) {
-          animateExit();
-          _levelIndex = newCell - Cell_WarpBase;
-          reset();
+      return changed;
+    }
 
-        } else {
-          switch (newCell) {
-            case Cell_Exit:
-              animateExit();
-              _trapCount = 0; // Reset the easter egg
-              _levelIndex = max(1, (_levelIndex + 1) % _levels.count); // Prevent exiting to level 0 from the last
-              reset();
-              break;
-            case Cell_Trap:
-              // Easter egg - level 0 is accessible from level 1
-              if (_levelIndex == 1 && ++_trapCount >= 10) {
-                _trapCount = 0;
-                animateExit();
-                _levelIndex = 0;
-                reset();
-              } else {
-                animateTrap();
-                reset();
-              }
-              break;
-            case Cell_Empty: // Move the ball
-              drawBall();
+    // Returns the invariants the balls break, as Invariant_ flags, and
+    // reports each ball that breaks one over telemetry. Physics should
+    // never let any of these happen.
+    byte checkInvariants() {
+      byte broken = 0;
+
+      for (byte i = 0; i < _balls.count; ++i) {
+        byte violations = ballViolations(i);
+        if (violations) {
+          telemetry.invariant(violations, i, _levelIndex, _balls.x[i], _balls.y[i]);
+          broken |= violations;
+        }
+      }
+
+      // Every occupied cell has to hold a ball, or balls will bounce off
+      // nothing there
+      for (int x = 0; x < WIDTH; ++x) {
+        for (int y = 0; y < HEIGHT; ++y) {
+          if (_occupied.contains(x, y) && ballAt(x, y) == NO_BALL) {
+            telemetry.invariant(Invariant_Occupancy, NO_BALL, _levelIndex, x, y);
+            broken |= Invariant_Occupancy;
           }
         }
       }
 
-      _lastUpdateTm = millis();
+      return broken;
+    }
 
-      return changed;
+    byte ballViolations(byte i) {
+      byte violations = 0;
+      float x = _balls.x[i];
+      float y = _balls.y[i];
+
+      if (x < 0.0 || y < 0.0 || x >= float(WIDTH) || y >= float(HEIGHT)) {
+        // The cell checks below would index outside the board
+        return Invariant_Bounds;
+      }
+
+      int xInt = _balls.xInt(i);
+      int yInt = _balls.yInt(i);
+
+      if (_solid.contains(xInt, yInt)) {
+        violations |= Invariant_Solid;
+      }
+
+      if (fabs(_balls.v_x[i]) > maxSpeed || fabs(_balls.v_y[i]) > maxSpeed) {
+        violations |= Invariant_Speed;
+      }
+
+      if (!_occupied.contains(xInt, yInt) || ballAt(xInt, yInt) != i) {
+        violations |= Invariant_Occupancy; // Not marked, or sharing the cell
+      }
+
+      return violations;
     }
 
-    void animateExit() {
-      uint32_t innerColor = _palette.colorForCell(Cell_Exit);
-      uint32_t outerColor = _palette.ballColor();
+    enum StepResult {
+      Step_Unchanged,
+      Step_Moved,
+      Step_Removed, // The ball left play and another took its index
+      Step_Reset    // The level was restarted or changed
+    };
+
+    // Advances ball i by one fixed step and handles the cell it lands in
+    StepResult step(byte i, float xAccel, float yAccel) {
+      int startingX = _balls.xInt(i);
+      int startingY = _balls.yInt(i);
+
+      updateBallPosition(i);
+
+      updateBallVelocity(i, xAccel, yAccel);
+
+      int x = _balls.xInt(i);
+      int y = _balls.yInt(i);
+
+      // If the ball's position hasn't crossed cell boundaries, the board is unchanged
+      if (x == startingX && y == startingY) {
+        return Step_Unchanged;
+      }
+
+      _occupied.remove(startingX, startingY);
+      _occupied.add(x, y);
+
+      byte newCell = level()->cellAt(x, y);
+
+      switch (Cell::event(newCell)) {
+        case Event_Teleport: {
+          byte destination = newCell - Cell_PointerBase;
+          byte row = destination / WIDTH;
+          byte col = destination % WIDTH;
+
+          animateTeleport(x, y, col, row);
+
+          _occupied.remove(x, y);
+          _occupied.add(col, row);
+
+          _balls.x[i] = col + 0.5;
+          _balls.y[i] = row + 0.5;
+          _balls.v_x[i] = 0.0;
+          _balls.v_y[i] = 0.0;
+          _balls.savePosition(i);
+
+          drawBalls();
+
+          restartClock();
+          break;
+        }
+
+        case Event_Warp:
+          exitTo(newCell - Cell_WarpBase, x, y);
+          return Step_Reset;
+
+        case Event_Exit:
+          removeBall(i);
+          if (_balls.count > 0) {
+            return Step_Removed;
+          }
+
+          // The last ball out completes the level
+          _trapCount = 0; // Reset the easter egg
+          exitTo(_exitFixed ? _exitLevel : followingLevel(), x, y);
+          return Step_Reset;
+
+        case Event_Trap: {
+          // Easter egg - level 0 is accessible from level 1
+          if (_levelIndex == 1 && ++_trapCount >= 10) {
+            _trapCount = 0;
+            exitTo(0, x, y);
+            return Step_Reset;
+          }
+
+          animateTrap(x, y);
+
+          // Only the trapped ball starts over
+          _occupied.remove(x, y);
+          bool respawned = spawnBall(i);
+          if (!respawned) {
+            removeBall(i);
+          }
+
+          redrawBoard();
+          drawBalls();
+          restartClock();
+          return respawned ? Step_Moved : Step_Removed;
+        }
+
+        case Event_None: { // Move the ball
+          byte element = switchAt(x, y);
+          if (element != NO_ELEMENT) {
+            toggleDoor(level()->element(element).period);
+          }
+        }
+      }
+
+      return Step_Moved;
+    }
+
+    void animateExit(int x, int y) {
+      uint16_t innerColor = Cell::color(Cell_Exit);
+      uint16_t outerColor = ColorPalette::ballColor();
 
       for (int j = 0; j < 6; j++) {
         for (int i = 0; i < 22; i += 2) {
-          _matrix.fillCircle(_ball.xInt(), _ball.yInt(), i, outerColor);
+          _matrix.fillCircle(x, y, i, outerColor);
           for (int k = i - 1; k >= 0; --k) {
-            uint32_t color = (k % 2) == (i % 2) ? outerColor : innerColor;
-            _matrix.drawCircle(_ball.xInt(), _ball.yInt(), k, color);
+            uint16_t color = (k % 2) == (i % 2) ? outerColor : innerColor;
+            _matrix.drawCircle(x, y, k, color);
           }
           _matrix.show();
-          delay(20);
+          idle(20, j == 5 && i == 20);
         }
 
-        uint32_t temp = outerColor;
+        uint16_t temp = outerColor;
         outerColor = innerColor;
         innerColor = temp;
       }
     }
 
-    void drawRectCentered(Adafruit_NeoMatrix& gfx, int x, int y, int width, int height, uint16_t color) {
+    void drawRectCentered(FrameMatrix& gfx, int x, int y, int width, int height, uint16_t color) {
       int leftX = x - width / 2;
       int topY = y - height / 2;
       gfx.drawRect(leftX, topY, width, height, color);
     }
 
-    void animateTrap() {
-      uint32_t innerColor = _palette.colorForCell(Cell_Trap);
-      uint32_t outerColor = _palette.white;
+    void animateTrap(int x, int y) {
+      uint16_t innerColor = Cell::color(Cell_Trap);
+      uint16_t outerColor = ColorPalette::white;
 
       for (int j = 0; j < 6; j++) {
         for (int i = 1; i < 8; i += 2) {
-          drawRectCentered(_matrix, _ball.xInt(), _ball.yInt(), i, i, outerColor);
+          drawRectCentered(_matrix, x, y, i, i, outerColor);
           for (int k = i - 1; k >= 0; --k) {
-            uint32_t color = (k % 2) == (i % 2) ? outerColor : innerColor;
-            drawRectCentered(_matrix, _ball.xInt(), _ball.yInt(), k, k, color);
+            uint16_t color = (k % 2) == (i % 2) ? outerColor : innerColor;
+            drawRectCentered(_matrix, x, y, k, k, color);
           }
           _matrix.show();
           delay(20);
         }
 
-        uint32_t temp = outerColor;
+        uint16_t temp = outerColor;
         outerColor = innerColor;
         innerColor = temp;
       }
     }
 
     void animateTeleport(int startX, int startY, int endX, int endY) {
-      uint32_t innerColor = _palette.colorForCell(Cell_PointerBase);
-      uint32_t outerColor = _palette.ballColor();
+      uint16_t innerColor = Cell::color(Cell_PointerBase);
+      uint16_t outerColor = ColorPalette::ballColor();
 
       for (int i = 0; i <= 10; i += 2) {
         _matrix.fillCircle(startX, startY, i, outerColor);
         for (int k = i - 1; k >= 0; --k) {
-          uint32_t color = (k % 2) == (i % 2) ? outerColor : innerColor;
+          uint16_t color = (k % 2) == (i % 2) ? outerColor : innerColor;
           _matrix.drawCircle(startX, startY, k, color);
         }
         _matrix.show();
@@ -236,7 +799,7 @@ class BoardController {
       for (int i = 10; i > 0; i -= 2) {
         _matrix.fillCircle(endX, endY, i, innerColor);
         for (int k = i - 1; k >= 0; --k) {
-          uint32_t color = (k % 2) == (i % 2) ? innerColor : outerColor;
+          uint16_t color = (k % 2) == (i % 2) ? innerColor : outerColor;
           _matrix.drawCircle(endX, endY, k, color);
         }
         _matrix.show();
@@ -245,195 +808,495 @@ class BoardController {
       }
     }
 
-    struct ColorPalette {
-      ColorPalette(Adafruit_NeoMatrix& matrix) {
-        orange = matrix.Color(90, 45, 0);
-        green = matrix.Color(0, 80, 0);
-        white = matrix.Color(60, 60, 60);
-        red = matrix.Color(80, 0, 0);
-        purple = matrix.Color(90, 0, 90);
-        off = matrix.Color(0, 0, 0);
-        blue = matrix.Color(0, 0, 80);
-        cyan = matrix.Color(0, 45, 90);
+    bool validLocation(int x, int y) {
+      // The edges of the board act as walls
+      if (x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT) {
+        return false;
+      }
+
+      return !_solid.contains(x, y);
+    }
+
+    // Returns true if a ball entering the cell has to stop there so step()
+    // can act on it
+    bool eventCell(int x, int y) {
+      return Cell::event(level()->cellAt(x, y)) != Event_None || switchAt(x, y) != NO_ELEMENT;
+    }
+
+    uint16_t colorAt(int x, int y) {
+      byte cell = level()->cellAt(x, y);
+      if (cell == Cell_Empty) {
+        if (_solid.contains(x, y)) return ColorPalette::cyan; // A closed door or mover
+        if (switchAt(x, y) != NO_ELEMENT) return ColorPalette::yellow;
       }
+      return Cell::color(cell);
+    }
 
-      uint32_t ballColor() {
-        return blue;
+    // The color of a cell with the hint drawn over it, the way the board
+    // looks under the balls
+    uint16_t boardColorAt(int x, int y) {
+      uint16_t color = colorAt(x, y);
+      if (color == ColorPalette::off) {
+        byte index = y * WIDTH + x;
+        for (byte i = 0; i < _hintLength; ++i) {
+          if (_hintPath[i] == index) return hintColor(i);
+        }
       }
+      return color;
+    }
 
-      uint32_t colorForCell(byte cell) {
-        if (cell >= Cell_PointerBase) return orange;
+    // Hint cells fade with distance from the ball
+    static uint16_t hintColor(byte i) {
+      return FrameMatrix::color(0, 48 - 7 * i, 0);
+    }
+
+    // Recomputes whether the cell blocks the ball. Used both to build the
+    // collision map and to patch it when elements change, so a patched map
+    // always matches a full rebuild.
+    void updateSolid(int x, int y) {
+      if (Cell::solid(level()->cellAt(x, y)) || elementCovers(x, y)) {
+        _solid.add(x, y);
+      } else {
+        _solid.remove(x, y);
+      }
+    }
 
-        if (cell > Cell_WarpBase) return green;
 
-        switch (cell) {
-          case Cell_WarpBase   : return purple;
-          case Cell_Wall       : return white;
-          case Cell_Wall_Purple   : return purple;
-          case Cell_Trap       : return red;
-          case Cell_Wall_Cyan: return cyan;
-          case Cell_Exit       : return green;
+    // Lights the cells leading from the first ball toward the nearest exit,
+    // dimmer farther along, once the player has been on the level a while.
+    // Returns true if the lit cells changed.
+    bool updateHint() {
+      if (cycleTimer.millis() - _levelStartTm < HINT_DELAY || !_distances.complete() || _balls.count == 0) {
+        return false;
+      }
 
-          case Cell_Empty      :
-          default              : return off;
+      // Follow the distances downhill until an exit or teleport
+      const int8_t dx[] = { 1, -1, 0, 0 };
+      const int8_t dy[] = { 0, 0, 1, -1 };
+      byte path[HINT_LENGTH];
+      byte length = 0;
+      int x = _balls.xInt(0);
+      int y = _balls.yInt(0);
+      // A ball that landed on a teleport waits to roll off it
+      byte code = level()->cellAt(x, y) == Cell_Empty ? _distances.code(x, y) : 0;
+      while (code != 0 && length < HINT_LENGTH) {
+        code = DistanceMap<WIDTH, HEIGHT>::closer(code);
+
+        byte k = 0;
+        while (k < 4 && _distances.code(x + dx[k], y + dy[k]) != code) {
+          ++k;
         }
+        if (k == 4) break;
+
+        x += dx[k];
+        y += dy[k];
+        if (level()->cellAt(x, y) != Cell_Empty) break;
+
+        path[length++] = y * WIDTH + x;
       }
 
-      uint32_t orange;
-      uint32_t green;
-      uint32_t white;
-      uint32_t red;
-      uint32_t purple;
-      uint32_t off;
-      uint32_t blue;
-      uint32_t cyan;
-    };
+      bool changed = length != _hintLength || memcmp(path, _hintPath, length) != 0;
 
-    bool validLocation(int x, int y) {
-      byte potential = level()->cellAt(x, y);
-      if (potential >= Cell_WarpBase) { // Covers warps and pointers
-        return true;
-      } else {
-        switch (potential) {
-          case Cell_Empty:
-          case Cell_Trap:
-          case Cell_Exit:
-            return true;
-          case Cell_Wall:
-          case Cell_Wall_Purple:
-          case Cell_Wall_Cyan:
-          default:   // Unknown cells treated like walls
-            return false;
+      // Doors and switches keep their colors. The balls are drawn over the
+      // hint by the next frame.
+      for (byte i = 0; i < _hintLength; ++i) {
+        int hx = _hintPath[i] % WIDTH;
+        int hy = _hintPath[i] / WIDTH;
+        _matrix.drawPixel(hx, hy, colorAt(hx, hy));
+      }
+      for (byte i = 0; i < length; ++i) {
+        int hx = path[i] % WIDTH;
+        int hy = path[i] / WIDTH;
+        if (colorAt(hx, hy) == ColorPalette::off) {
+          _matrix.drawPixel(hx, hy, hintColor(i));
         }
       }
-    }
 
-    void updateBallPosition() {
-      // Apply the ball's velocity to its position if possible
+      memcpy(_hintPath, path, length);
+      _hintLength = length;
+      return changed;
+    }
 
-      float potentialX = _ball.x + _ball.v_x;
-      float potentialY = _ball.y + _ball.v_y;
+    // Patches the collision map and framebuffer for the cells of a rectangle
+    void refreshRect(int x, int y, byte width, byte height) {
+      for (int i = x; i < x + width; ++i) {
+        for (int j = y; j < y + height; ++j) {
+          updateSolid(i, j);
+          _matrix.drawPixel(i, j, colorAt(i, j));
+        }
+      }
+    }
 
-      if (potentialX < 0) {
-        potentialX = 0.0 + _ball.radius;
-      } else if (int(potentialX) >= _matrix.width()) {
-        potentialX = _matrix.width() - _ball.radius;
+    bool anyBallIn(int x, int y, byte width, byte height) {
+      for (int i = x; i < x + width; ++i) {
+        for (int j = y; j < y + height; ++j) {
+          if (_occupied.contains(i, j)) return true;
+        }
       }
+      return false;
+    }
 
-      if (potentialY < 0) {
-        potentialY = 0.0 + _ball.radius;
-      } else if (int(potentialY) >= _matrix.height()) {
-        potentialY = _matrix.height() - _ball.radius;
+    // Current top left cell of an element
+    int elementX(const LevelElement& e, byte i) {
+      return e.kind == Element_Mover ? e.x + e.dx * _elementStates[i].position : e.x;
+    }
+    int elementY(const LevelElement& e, byte i) {
+      return e.kind == Element_Mover ? e.y + e.dy * _elementStates[i].position : e.y;
+    }
+
+    bool elementContains(const LevelElement& e, byte i, int x, int y) {
+      int left = elementX(e, i);
+      int top = elementY(e, i);
+      return x >= left && x < left + e.width && y >= top && y < top + e.height;
+    }
+
+    // Returns true if a closed door or a mover is in the cell
+    bool elementCovers(int x, int y) {
+      for (byte i = 0; i < level()->elementCount; ++i) {
+        LevelElement e = level()->element(i);
+        if (e.kind == Element_Switch || (e.kind == Element_Door && !_elementStates[i].active)) continue;
+        if (elementContains(e, i, x, y)) return true;
       }
+      return false;
+    }
 
-      // If not changing cells, no need to check interference
-      if (int(potentialX) == _ball.xInt() && int(potentialY) == _ball.yInt()) {
-        _ball.x = potentialX;
-        _ball.y = potentialY;
-        return;
+    // Returns the index of the switch in the cell, or NO_ELEMENT
+    byte switchAt(int x, int y) {
+      for (byte i = 0; i < level()->elementCount; ++i) {
+        LevelElement e = level()->element(i);
+        if (e.kind == Element_Switch && elementContains(e, i, x, y)) return i;
       }
+      return NO_ELEMENT;
+    }
 
-      if (int(potentialX) != _ball.xInt() && int(potentialY) != _ball.yInt()) {
-        // Both X & Y position potentially changing
-        byte pathAValid = validLocation(_ball.xInt(), int(potentialY));
-        byte pathBValid = validLocation(int(potentialX), _ball.yInt());
+    void resetElements() {
+      _elementSteps = 0;
+      for (byte i = 0; i < level()->elementCount; ++i) {
+        _elementStates[i].countdown = level()->element(i).period;
+        _elementStates[i].position = 0;
+        _elementStates[i].active = true; // Doors start closed, movers forward
+        _elementStates[i].waiting = false;
+      }
+    }
 
-        if (validLocation(int(potentialX), int(potentialY))) {
-          if (pathAValid && pathBValid) {
-            _ball.x = potentialX;
-            _ball.y = potentialY;
-          } else if (pathAValid) {
-            _ball.y = potentialY;
-          } else if (pathBValid) {
-            _ball.x = potentialX;
+    // Advances the timed elements by one element tick. Returns true if any
+    // of them changed.
+    bool tickElements() {
+      bool changed = false;
+      for (byte i = 0; i < level()->elementCount; ++i) {
+        LevelElement e = level()->element(i);
+        ElementState& state = _elementStates[i];
+        if (e.kind == Element_Switch) continue;
+
+        // Retry a toggle a ball held back, then keep to the period from there
+        if (state.waiting) {
+          state.waiting = false;
+          if (toggleDoor(i)) {
+            state.countdown = e.period;
+            changed = true;
           }
+          continue;
         }
-      } else if (int(potentialY) != _ball.yInt()) {
 
-        // If potential destination is not a valid location,
-        // place the ball as close as it can get.
-        if (validLocation(_ball.xInt(), int(potentialY))) {
-          _ball.y = potentialY;
-        } else if (potentialY > _ball.y) {
-          _ball.y = float(int(potentialY)) - _ball.radius;
+        if (e.period == 0 || --state.countdown > 0) continue;
+
+        state.countdown = e.period;
+        if (e.kind == Element_Door) {
+          changed |= toggleDoor(i);
         } else {
-          _ball.y = float(int(potentialY + 1)) + _ball.radius;
+          changed |= moveMover(i);
+        }
+      }
+      return changed;
+    }
+
+    // Opens or closes a door. A door won't close on a ball: the toggle
+    // waits, and tickElements() retries it until the ball has gone. A
+    // second toggle while one waits cancels both. Returns true if the door
+    // changed.
+    bool toggleDoor(byte i) {
+      LevelElement e = level()->element(i);
+      ElementState& state = _elementStates[i];
+
+      if (state.waiting) {
+        state.waiting = false;
+        return false;
+      }
+
+      if (!state.active && anyBallIn(e.x, e.y, e.width, e.height)) {
+        state.waiting = true;
+        return false;
+      }
+
+      state.active = !state.active;
+      refreshRect(e.x, e.y, e.width, e.height);
+      return true;
+    }
+
+    // Slides a mover one move along its track, reversing at the ends of its
+    // travel or when a ball is in the way. Returns true if the mover moved.
+    bool moveMover(byte i) {
+      LevelElement e = level()->element(i);
+      ElementState& state = _elementStates[i];
+
+      if ((state.active && state.position == e.travel) || (!state.active && state.position == 0)) {
+        state.active = !state.active;
+      }
+
+      int x = elementX(e, i);
+      int y = elementY(e, i);
+      int step = state.active ? 1 : -1;
+
+      if (anyBallIn(x + e.dx * step, y + e.dy * step, e.width, e.height)) {
+        state.active = !state.active;
+        return false;
+      }
+
+      state.position += step;
+      refreshRect(x, y, e.width, e.height);
+      refreshRect(elementX(e, i), elementY(e, i), e.width, e.height);
+      return true;
+    }
+
+    // Returns true if ball i may move into the cell. Otherwise updates the
+    // ball's velocity along the direction of travel for the collision: a wall
+    // stops it, while another ball swaps velocities with it as in an elastic
+    // collision between equal masses.
+    bool tryEnter(byte i, int x, int y, bool alongX) {
+      float& v = alongX ? _balls.v_x[i] : _balls.v_y[i];
+
+      if (!validLocation(x, y)) {
+        v = 0.0;
+        return false;
+      }
+
+      if (_occupied.contains(x, y)) {
+        byte other = ballAt(x, y);
+        float& otherV = alongX ? _balls.v_x[other] : _balls.v_y[other];
+        float temp = v;
+        v = otherV;
+        otherV = temp;
+        return false;
+      }
+
+      // A teleport can't deliver onto another ball or into a wall
+      byte cell = level()->cellAt(x, y);
+      if (Cell::event(cell) == Event_Teleport) {
+        byte destination = cell - Cell_PointerBase;
+        int col = destination % WIDTH;
+        int row = destination / WIDTH;
+        if (_occupied.contains(col, row) || !validLocation(col, row)) {
+          v = 0.0;
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    // Returns the index of the ball in an occupied cell
+    byte ballAt(int x, int y) {
+      for (byte i = 0; i < _balls.count; ++i) {
+        if (_balls.xInt(i) == x && _balls.yInt(i) == y) {
+          return i;
         }
+      }
+      return NO_BALL;
+    }
+
+    // Keeps a coordinate inside the cell the traversal ended in, absorbing
+    // rounding at the cell boundaries.
+    float keepInCell(float pos, int cell) {
+      if (pos < cell) {
+        return float(cell);
+      } else if (pos >= cell + 1) {
+        return float(cell + 1) - Balls::radius;
+      }
+      return pos;
+    }
+
+    void updateBallPosition(byte i) {
+      // Apply the ball's velocity to its position, visiting every cell its
+      // path crosses in order (Amanatides & Woo grid traversal). A wall or
+      // another ball stops motion along the axis that hit it while the other
+      // axis carries on, so the ball slides along walls. Entering a cell that
+      // does something (trap, exit, warp or teleport) ends the move there for
+      // step().
+
+      // Fractions of this step's motion beyond the end of the step
+      const float NEVER = 2.0;
+
+      float x = _balls.x[i];
+      float y = _balls.y[i];
 
-        _ball.x = potentialX;
-      } else if (int(potentialX) != _ball.xInt()) {
+      int cellX = int(x);
+      int cellY = int(y);
 
-        // If potential destination is not a valid location,
-        // place the ball as close as it can get.
-        if (validLocation(int(potentialX), _ball.yInt())) {
-          _ball.x = potentialX;
-        } else if (potentialX > _ball.x) {
-          _ball.x = float(int(potentialX)) - _ball.radius;
+      float v_x = _balls.v_x[i];
+      float v_y = _balls.v_y[i];
+
+      float endX = x + v_x;
+      float endY = y + v_y;
+
+      int stepX = v_x > 0 ? 1 : -1;
+      int stepY = v_y > 0 ? 1 : -1;
+
+      // Fraction of the move at which the next X (Y) cell boundary is
+      // crossed, and the fraction it takes to cross a whole cell.
+      float tMaxX = NEVER, tDeltaX = NEVER;
+      if (v_x != 0.0) {
+        tMaxX = ((stepX > 0 ? cellX + 1 : cellX) - x) / v_x;
+        tDeltaX = 1.0 / fabs(v_x);
+      }
+
+      float tMaxY = NEVER, tDeltaY = NEVER;
+      if (v_y != 0.0) {
+        tMaxY = ((stepY > 0 ? cellY + 1 : cellY) - y) / v_y;
+        tDeltaY = 1.0 / fabs(v_y);
+      }
+
+      while (tMaxX < 1.0 || tMaxY < 1.0) {
+        float t;
+
+        if (tMaxX <= tMaxY) {
+          t = tMaxX;
+          if (!tryEnter(i, cellX + stepX, cellY, true)) {
+            // Place the ball as close to the obstacle as it can get
+            endX = stepX > 0 ? float(cellX + 1) - Balls::radius : float(cellX) + Balls::radius;
+            v_x = 0.0;
+            tMaxX = NEVER;
+            continue;
+          }
+          cellX += stepX;
+          tMaxX += tDeltaX;
         } else {
-          _ball.x = float(int(potentialX + 1)) + _ball.radius;
+          t = tMaxY;
+          if (!tryEnter(i, cellX, cellY + stepY, false)) {
+            endY = stepY > 0 ? float(cellY + 1) - Balls::radius : float(cellY) + Balls::radius;
+            v_y = 0.0;
+            tMaxY = NEVER;
+            continue;
+          }
+          cellY += stepY;
+          tMaxY += tDeltaY;
         }
 
-        _ball.y = potentialY;
+        if (eventCell(cellX, cellY)) {
+          // Stop where the path entered the cell
+          if (v_x != 0.0) endX = x + v_x * t;
+          if (v_y != 0.0) endY = y + v_y * t;
+          break;
+        }
       }
+
+      _balls.x[i] = keepInCell(endX, cellX);
+      _balls.y[i] = keepInCell(endY, cellY);
     }
 
     const float deadZone = 0.08;
-    const float velocityDecay = 0.75;
+    const float velocityDecay = 0.5625; // 0.75 per 5 ms, compounded over one step
+    const float accelGain = 200.0;      // cells/sec^2 per radian of tilt
+
+    // The traversal in updateBallPosition() can't tunnel through walls, so
+    // speed is capped for playability rather than to keep moves to one cell.
+    const float maxSpeed = 3.0;         // cells per step
+
+    void updateBallVelocity(byte i, float xAccel, float yAccel) {
+      // Velocity is kept in cells per step
+      const float dv = accelGain * PERIOD * PERIOD / 1000000.0;
+
+      const float radius = Balls::radius;
+      float x = _balls.x[i];
+      float y = _balls.y[i];
+      float& v_x = _balls.v_x[i];
+      float& v_y = _balls.v_y[i];
 
-    void updateBallVelocity() {
-      float xAccel = -1.0 * _accel.readXAxis();
       if (fabs(xAccel) < deadZone) {
-        _ball.v_x *= velocityDecay;
+        v_x *= velocityDecay;
       } else if (xAccel >= 0) {
         // If accelerating against a wall or edge, set velocity to zero
-        if (_ball.x + _ball.radius >= float(_matrix.width()) || !validLocation(int(_ball.x + _ball.radius + EPSILON), _ball.yInt())) {
-          _ball.v_x = 0.0;
+        if (x + radius >= float(WIDTH) || !validLocation(int(x + radius + EPSILON), int(y))) {
+          v_x = 0.0;
         } else {
-          _ball.v_x += xAccel * PERIOD / 1000.0;
+          v_x += xAccel * dv;
         }
       } else {
-        if (_ball.x - _ball.radius - EPSILON <= 0.0 || !validLocation(int(_ball.x - _ball.radius - EPSILON), _ball.yInt())) {
-          _ball.v_x = 0.0;
+        if (x - radius - EPSILON <= 0.0 || !validLocation(int(x - radius - EPSILON), int(y))) {
+          v_x = 0.0;
         } else {
-          _ball.v_x += xAccel * PERIOD / 1000.0;
+          v_x += xAccel * dv;
         }
       }
-      _ball.v_x = max(-1.0, min(1.0, _ball.v_x));
+      v_x = max(-maxSpeed, min(maxSpeed, v_x));
 
-      float yAccel = -1.0 * _accel.readYAxis();
       if (fabs(yAccel) < deadZone) {
-        _ball.v_y *= velocityDecay;
+        v_y *= velocityDecay;
       } else if (yAccel >= 0) {
         // If accelerating against a wall or edge, set velocity to zero
-        if (_ball.y + _ball.radius >= float(_matrix.height()) || !validLocation(_ball.xInt(), int(_ball.y + _ball.radius + EPSILON))) {
-          _ball.v_y = 0.0;
+        if (y + radius >= float(HEIGHT) || !validLocation(int(x), int(y + radius + EPSILON))) {
+          v_y = 0.0;
         } else {
-          _ball.v_y += yAccel * PERIOD / 1000.0;
+          v_y += yAccel * dv;
         }
       } else {
-        if (_ball.y - _ball.radius - EPSILON <= 0.0 || !validLocation(_ball.xInt(), int(_ball.y - _ball.radius - EPSILON))) {
-          _ball.v_y = 0.0;
+        if (y - radius - EPSILON <= 0.0 || !validLocation(int(x), int(y - radius - EPSILON))) {
+          v_y = 0.0;
         } else {
-          _ball.v_y += yAccel * PERIOD / 1000.0;
+          v_y += yAccel * dv;
         }
       }
-      _ball.v_y = max(-1.0, min(1.0, _ball.v_y));
+      v_y = max(-maxSpeed, min(maxSpeed, v_y));
     }
 
   protected:
-    Adafruit_NeoMatrix& _matrix;
-    Accelerometer& _accel;
-    LevelSet& _levels;
+    FrameMatrix& _matrix;
+    InputProvider* _input;
+    LevelSet<WIDTH, HEIGHT>& _levels;
     byte _levelIndex;
-    long _lastUpdateTm;
-    Ball _ball;
+    Level<WIDTH, HEIGHT> _level; // RAM copy of the level being played
+    MazeLevel<WIDTH, HEIGHT> _maze; // Read by _level when playing a generated maze
+    uint32_t _lastUpdateTm;
+    uint32_t _pendingTm; // Elapsed millis not yet simulated
+    Balls _balls;
+    CellSet<WIDTH, HEIGHT> _occupied; // Cells holding a ball
+    byte _ballCount;
+    byte _ballPixels[4 * MAX_BALLS]; // Pixels drawn over by the balls, as indexes
+    byte _ballPixelCount;
+    int16_t _drawnX[MAX_BALLS]; // Where the balls were last drawn, in 256ths of a cell
+    int16_t _drawnY[MAX_BALLS];
+    byte _drawnCount;
+    bool _boardChanged; // Drawn since the last frame was shown
+    uint32_t _lastFrameTm;
+    CellSet<WIDTH, HEIGHT> _solid; // Cells that block the balls, including closed doors and movers
+
+    struct ElementState {
+      byte countdown; // Element ticks until the next change
+      byte position;  // Movers: moves made from the start of the track
+      bool active;    // Doors: closed. Movers: moving forward
+      bool waiting;   // Doors: a toggle is held back by a ball in the way
+    };
+    ElementState _elementStates[MAX_ELEMENTS];
+    byte _elementSteps; // Physics steps since the last element tick
+
     byte _trapCount;
-    ColorPalette _palette;
+    byte _exitLevel; // Where the exit leads, if _exitFixed
+    bool _exitFixed;
+
+    bool _generating; // The maze being loaded isn't generated yet
+    byte _loadRow; // Rows of the collision map loaded, then HEIGHT + 1 once the balls are placed
+    bool _levelDrawn; // The level being loaded is drawn, waiting to be shown
+
+    DistanceMap<WIDTH, HEIGHT> _distances; // Steps to the exit, for the hint
+    uint32_t _levelStartTm;
+    byte _hintPath[HINT_LENGTH]; // Lit cells, as indexes
+    byte _hintLength;
 
-    const long PERIOD = 5; // millis
+    const long PERIOD = 10; // millis per physics step
+    const byte MAX_STEPS = 5; // Most steps simulated by one update()
+    const long ELEMENT_TICK = 100; // millis, the unit of element periods
 
-    Level* level() {
-      return &_levels.levels[_levelIndex];
+    Level<WIDTH, HEIGHT>* level() {
+      return &_level;
     }
 };
 
@@ -0,0 +1,60 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CELLSET_HPP_
+#define _CELLSET_HPP_
+
+#include "FrameMatrix.hpp"
+
+// A set of cells on a board of WIDTH x HEIGHT, stored as one bit per cell.
+template <byte WIDTH = MATRIX_WIDTH, byte HEIGHT = MATRIX_HEIGHT>
+class CellSet {
+  public:
+    CellSet() {
+      clear();
+    }
+
+    void clear() {
+      memset(_bits, 0, sizeof(_bits));
+    }
+
+    bool contains(int x, int y) const {
+      int i = index(x, y);
+      return _bits[i >> 3] & (1 << (i & 7));
+    }
+
+    void add(int x, int y) {
+      int i = index(x, y);
+      _bits[i >> 3] |= (1 << (i & 7));
+    }
+
+    void remove(int x, int y) {
+      int i = index(x, y);
+      _bits[i >> 3] &= ~(1 << (i & 7));
+    }
+
+  protected:
+    static int index(int x, int y) {
+      return y * WIDTH + x;
+    }
+
+    byte _bits[(WIDTH * HEIGHT + 7) / 8];
+};
+
+#endif
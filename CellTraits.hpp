@@ -0,0 +1,105 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CELLTRAITS_HPP_
+#define _CELLTRAITS_HPP_
+
+#include "Levels.hpp"
+
+// Colors are compile-time constants, so the palette takes no RAM
+struct ColorPalette {
+  static constexpr uint16_t orange = FrameMatrix::color(90, 45, 0);
+  static constexpr uint16_t green = FrameMatrix::color(0, 80, 0);
+  static constexpr uint16_t white = FrameMatrix::color(60, 60, 60);
+  static constexpr uint16_t red = FrameMatrix::color(80, 0, 0);
+  static constexpr uint16_t purple = FrameMatrix::color(90, 0, 90);
+  static constexpr uint16_t off = FrameMatrix::color(0, 0, 0);
+  static constexpr uint16_t blue = FrameMatrix::color(0, 0, 80);
+  static constexpr uint16_t cyan = FrameMatrix::color(0, 45, 90);
+  static constexpr uint16_t yellow = FrameMatrix::color(70, 60, 0);
+
+  static uint16_t ballColor() {
+    return blue;
+  }
+};
+
+// What happens to a ball that enters a cell. Each plays its own animation.
+const byte Event_None = 0;
+const byte Event_Exit = 1;     // Leaves the level, to the next one when the last ball is out
+const byte Event_Trap = 2;     // Starts the ball over
+const byte Event_Warp = 3;     // Goes to the level given by the cell
+const byte Event_Teleport = 4; // Moves the ball to the cell given by the cell
+
+// Cell types index the trait table. Cells below Cell_WarpBase are their
+// own type; the warp and pointer ranges share a type each.
+const byte CellType_Unknown = Cell_Wall_Cyan + 1; // Undefined cells, treated like walls
+const byte CellType_WarpHome = CellType_Unknown + 1; // Warp to level 0
+const byte CellType_Warp = CellType_WarpHome + 1;
+const byte CellType_Pointer = CellType_Warp + 1;
+
+struct CellTraits {
+  bool solid;     // Blocks the ball
+  byte event;     // What entering the cell does
+  uint16_t color;
+};
+
+// One row per cell type. A new cell type is a new constant in Levels.hpp
+// and a row here, ahead of CellType_Unknown.
+const CellTraits cellTraits[] PROGMEM = {
+  /* Cell_Empty       */ { false, Event_None,     ColorPalette::off },
+  /* Cell_Wall        */ { true,  Event_None,     ColorPalette::white },
+  /* Cell_Trap        */ { false, Event_Trap,     ColorPalette::red },
+  /* Cell_Exit        */ { false, Event_Exit,     ColorPalette::green },
+  /* Cell_Wall_Purple */ { true,  Event_None,     ColorPalette::purple },
+  /* Cell_Wall_Cyan   */ { true,  Event_None,     ColorPalette::cyan },
+  /* Unknown          */ { true,  Event_None,     ColorPalette::off },
+  /* WarpHome         */ { false, Event_Warp,     ColorPalette::purple },
+  /* Warp             */ { false, Event_Warp,     ColorPalette::green },
+  /* Pointer          */ { false, Event_Teleport, ColorPalette::orange },
+};
+
+static_assert(sizeof(cellTraits) / sizeof(cellTraits[0]) == CellType_Pointer + 1, "Every cell type needs a row of traits");
+
+// Looks up the traits of a cell value
+class Cell {
+  public:
+    static bool solid(byte cell) {
+      return pgm_read_byte(&cellTraits[type(cell)].solid);
+    }
+
+    static byte event(byte cell) {
+      return pgm_read_byte(&cellTraits[type(cell)].event);
+    }
+
+    static uint16_t color(byte cell) {
+      return pgm_read_word(&cellTraits[type(cell)].color);
+    }
+
+  protected:
+    // The only place cell values are range checked. Walls and empty cells,
+    // which make up most of a board, take the first test.
+    static byte type(byte cell) {
+      if (cell < CellType_Unknown) return cell;
+      if (cell < Cell_WarpBase) return CellType_Unknown;
+      if (cell < Cell_PointerBase) return cell == Cell_WarpBase ? CellType_WarpHome : CellType_Warp;
+      return CellType_Pointer;
+    }
+};
+
+#endif
@@ -0,0 +1,133 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CYCLETIMER_HPP_
+#define _CYCLETIMER_HPP_
+
+#if F_CPU != 16000000L
+#error "CycleTimer assumes a 16 MHz clock, so that a Timer1 tick is 0.5 us"
+#endif
+
+// Timer1 overflows since begin(), extending its count to 32 bits
+volatile uint16_t timer1Overflows = 0;
+
+// Time in the overflows so far, as whole millis and leftover micros
+volatile uint32_t timer1Millis = 0;
+volatile uint16_t timer1Micros = 0;
+
+ISR(TIMER1_OVF_vect) {
+  ++timer1Overflows;
+
+  // An overflow is 65536 ticks, 32.768 ms
+  timer1Millis += 32;
+  timer1Micros += 768;
+  if (timer1Micros >= 1000) {
+    timer1Micros -= 1000;
+    ++timer1Millis;
+  }
+}
+
+// Counts CPU cycles using Timer1, which nothing else in the sketch uses.
+// The timer runs at clk/8, so counts are exact to 8 cycles, and it
+// overflows every 32 ms. Interrupts are never disabled for that long (a
+// frame's show() takes about 7 ms), so no overflow is missed.
+//
+// That also makes it a clock that keeps time through show(). millis()
+// counts Timer0 overflows every 1.024 ms, and loses the ones that come
+// while show() has interrupts off.
+class CycleTimer {
+  public:
+    void begin() {
+      TCCR1A = 0;
+      TCCR1B = bit(CS11); // clk/8
+      TCNT1 = 0;
+      TIMSK1 = bit(TOIE1);
+      _millisAtBegin = ::millis();
+    }
+
+    // Timer ticks since begin(), 8 CPU cycles each
+    uint32_t ticks() {
+      uint8_t oldSREG = SREG;
+      cli();
+
+      uint16_t count = TCNT1;
+      uint16_t overflows = timer1Overflows;
+
+      // An overflow that happened while interrupts were off hasn't been
+      // counted by the ISR yet
+      if ((TIFR1 & bit(TOV1)) && count < 0x8000) {
+        ++overflows;
+      }
+
+      SREG = oldSREG;
+      return (uint32_t(overflows) << 16) | count;
+    }
+
+    uint32_t cycles() {
+      return ticks() * 8;
+    }
+
+    // Millis since begin(), counting time with interrupts off
+    uint32_t millis() {
+      uint32_t ms;
+      uint16_t us;
+      now(ms, us);
+      return ms + us / 1000;
+    }
+
+    // Micros since begin(), counting time with interrupts off. Wraps
+    // around every 71 minutes, like micros().
+    uint32_t micros() {
+      uint32_t ms;
+      uint16_t us;
+      now(ms, us);
+      return ms * 1000 + us;
+    }
+
+    // How far millis() has fallen behind since begin()
+    int32_t millisDrift() {
+      return int32_t(millis() - (::millis() - _millisAtBegin));
+    }
+
+  protected:
+    // The time as millis and micros past them, up to 33 ms of them
+    void now(uint32_t& ms, uint16_t& us) {
+      uint8_t oldSREG = SREG;
+      cli();
+
+      uint16_t count = TCNT1;
+      ms = timer1Millis;
+      us = timer1Micros;
+
+      // As in ticks(), an overflow the ISR hasn't seen yet
+      if ((TIFR1 & bit(TOV1)) && count < 0x8000) {
+        ms += 32;
+        us += 768;
+      }
+
+      SREG = oldSREG;
+      us += count / 2;
+    }
+
+    uint32_t _millisAtBegin;
+};
+
+CycleTimer cycleTimer;
+
+#endif
@@ -0,0 +1,176 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _DISTANCEMAP_HPP_
+#define _DISTANCEMAP_HPP_
+
+#include "CellSet.hpp"
+#include "Levels.hpp"
+
+// Steps from each cell of a level to the nearest exit, found by a
+// breadth-first search outward from the exits. Moving onto a teleport
+// counts as a step to its destination.
+//
+// To fit a 17x13 board in under 150 bytes, each cell keeps only a 4-bit code: 0 for not
+// reached, otherwise the distance mod 15 plus 1. That's enough to follow
+// the distances downhill to an exit, since neighboring cells differ by at
+// most one step. The search goes a layer at a time, each one a pass over
+// the whole grid, and a pass can be spread over many calls to advance().
+template <byte WIDTH = MATRIX_WIDTH, byte HEIGHT = MATRIX_HEIGHT>
+class DistanceMap {
+  public:
+    // Starts a new search of a level, discarding the old one
+    void begin() {
+      memset(_codes, 0, sizeof(_codes));
+      _frontier.clear();
+      _cursor = 0;
+      _layer = SEEDING;
+      _grew = false;
+      _grewLastPass = true;
+      _complete = false;
+    }
+
+    // Runs the search over up to `cells` more cells. Returns true once the
+    // search is complete.
+    bool advance(Level<WIDTH, HEIGHT>* level, byte cells) {
+      while (cells-- > 0 && !_complete) {
+        byte x = _cursor % WIDTH;
+        byte y = _cursor / WIDTH;
+
+        if (_layer == SEEDING) {
+          if (level->cellAt(x, y) == Cell_Exit) {
+            reach(x, y, 0);
+          }
+        } else {
+          expand(level, x, y);
+        }
+
+        if (++_cursor == WIDTH * HEIGHT) {
+          // A teleport can be reached a pass after the layer its
+          // destination's neighbors are in, so it takes two passes reaching
+          // nothing new to be sure every reachable cell has its distance.
+          _complete = !_grew && !_grewLastPass;
+          _cursor = 0;
+          _grewLastPass = _grew;
+          _grew = false;
+          ++_layer;
+        }
+      }
+      return _complete;
+    }
+
+    bool complete() {
+      return _complete;
+    }
+
+    byte code(int x, int y) {
+      if (x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT) return 0;
+
+      int i = y * WIDTH + x;
+      return (i & 1) ? _codes[i / 2] >> 4 : _codes[i / 2] & 0x0F;
+    }
+
+    // The code of a cell one step closer to an exit than a cell with code c
+    static byte closer(byte c) {
+      return c == 1 ? 15 : c - 1;
+    }
+
+  protected:
+    // _layer during the first pass, which finds the exits
+    static const byte SEEDING = 0xFF;
+
+    static byte codeFor(byte distance) {
+      return distance % 15 + 1;
+    }
+
+    void setCode(int x, int y, byte c) {
+      int i = y * WIDTH + x;
+      if (i & 1) {
+        _codes[i / 2] = (_codes[i / 2] & 0x0F) | (c << 4);
+      } else {
+        _codes[i / 2] = (_codes[i / 2] & 0xF0) | c;
+      }
+    }
+
+    void reach(int x, int y, byte distance) {
+      setCode(x, y, codeFor(distance));
+      _frontier.add(x, y);
+      _grew = true;
+    }
+
+    // The frontier holds the cells of this layer and the next. Cells added
+    // during a pass have the next layer's code, so they wait for the next
+    // pass even if the scan reaches them in this one.
+    void expand(Level<WIDTH, HEIGHT>* level, int x, int y) {
+      byte layerCode = codeFor(_layer);
+      byte nextLayer = _layer + 1;
+
+      if (_frontier.contains(x, y)) {
+        if (code(x, y) != layerCode) return;
+
+        _frontier.remove(x, y);
+        const int8_t dx[] = { 1, -1, 0, 0 };
+        const int8_t dy[] = { 0, 0, 1, -1 };
+        for (byte k = 0; k < 4; ++k) {
+          int nx = x + dx[k];
+          int ny = y + dy[k];
+          if (nx < 0 || ny < 0 || nx >= WIDTH || ny >= HEIGHT) continue;
+          if (code(nx, ny) == 0 && level->cellAt(nx, ny) == Cell_Empty) {
+            reach(nx, ny, nextLayer);
+          }
+        }
+
+      } else if (code(x, y) == 0) {
+        // A teleport is one step farther than its destination. Everything
+        // in this layer got its code in the last pass, and a teleport
+        // would already have been reached from an earlier layer with the
+        // same code.
+        byte cell = level->cellAt(x, y);
+        if (cell >= Cell_PointerBase) {
+          byte destination = cell - Cell_PointerBase;
+          if (standingDistanceIs(level, destination % WIDTH, destination / WIDTH, layerCode)) {
+            reach(x, y, nextLayer);
+          }
+        }
+      }
+    }
+
+    // Whether a ball standing in a cell is in this layer. A teleport can
+    // land a ball on a cell it couldn't roll onto, like another teleport,
+    // and then it's a step from whichever neighbor is nearest.
+    bool standingDistanceIs(Level<WIDTH, HEIGHT>* level, int x, int y, byte layerCode) {
+      if (level->cellAt(x, y) == Cell_Empty) {
+        return code(x, y) == layerCode;
+      }
+
+      byte previousCode = closer(layerCode);
+      return code(x + 1, y) == previousCode || code(x - 1, y) == previousCode ||
+             code(x, y + 1) == previousCode || code(x, y - 1) == previousCode;
+    }
+
+    byte _codes[(WIDTH * HEIGHT + 1) / 2];
+    CellSet<WIDTH, HEIGHT> _frontier;
+    byte _cursor;   // Cell index the scan is at in this pass
+    byte _layer;    // Distance of the cells this pass expands from
+    bool _grew;     // Whether this pass reached any new cells
+    bool _grewLastPass;
+    bool _complete;
+};
+
+#endif
@@ -0,0 +1,329 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _FRAMEMATRIX_HPP_
+#define _FRAMEMATRIX_HPP_
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_NeoPixel.h>
+#include <Adafruit_NeoMatrix.h>
+
+#include "CycleTimer.hpp"
+#include "FrameMirror.hpp"
+
+// Dimensions of the LED matrix
+#define MATRIX_WIDTH 17
+#define MATRIX_HEIGHT 13
+
+// Most current the LEDs may draw, in milliamps
+#ifndef POWER_BUDGET_MA
+#define POWER_BUDGET_MA 500
+#endif
+
+static_assert(POWER_BUDGET_MA > MATRIX_WIDTH * MATRIX_HEIGHT, "Power budget doesn't cover the idle current of the LEDs");
+
+// LED output for each value of a 5 bit color channel, with gamma 2.2, in
+// 256ths of a step of the LED's 0..255 range
+const uint16_t gammaTable5[] PROGMEM = {
+  0, 34, 157, 383, 722, 1179, 1761, 2472,
+  3316, 4297, 5417, 6681, 8091, 9648, 11357, 13219,
+  15235, 17409, 19742, 22235, 24891, 27712, 30698, 33852,
+  37175, 40668, 44333, 48171, 52183, 56372, 60737, 65280
+};
+
+// The same for 6 bit channels
+const uint16_t gammaTable6[] PROGMEM = {
+  0, 7, 33, 81, 152, 248, 370, 519,
+  697, 903, 1138, 1404, 1700, 2027, 2386, 2777,
+  3201, 3658, 4148, 4672, 5230, 5823, 6450, 7113,
+  7811, 8545, 9315, 10121, 10964, 11844, 12761, 13716,
+  14708, 15738, 16807, 17914, 19059, 20243, 21466, 22729,
+  24031, 25372, 26753, 28175, 29636, 31139, 32681, 34265,
+  35889, 37555, 39261, 41010, 42799, 44631, 46505, 48420,
+  50378, 52379, 54422, 56507, 58636, 60807, 63022, 65280
+};
+
+// Ordered dithering thresholds for a 4x4 block of pixels
+const uint8_t ditherTable[] PROGMEM = {
+  8, 136, 40, 168,
+  200, 72, 232, 104,
+  56, 184, 24, 152,
+  248, 120, 216, 88
+};
+
+// The picture frame's LED matrix. Keeps a running total of the channel
+// values in the framebuffer as pixels are drawn, and uses it to hold the
+// estimated current under POWER_BUDGET_MA by lowering the brightness when
+// a frame would exceed it.
+//
+// Colors are gamma corrected and scaled by the brightness through tables as
+// they're drawn, rather than by the NeoPixel library, which is left at full
+// brightness. The tables are rebuilt in RAM whenever the brightness
+// changes, so drawing a pixel only looks its channels up. The fraction of a
+// step left over is dithered with a fixed 4x4 ordered pattern, so dim
+// colors and gradients keep their shades across the board. The dithering
+// is spatial only: a pixel keeps the level it was drawn with until it's
+// drawn again. Dithering over time would mean keeping every pixel's color
+// as well as its bytes, 442 more bytes than the RAM has to spare.
+class FrameMatrix : public Adafruit_NeoMatrix {
+  public:
+    FrameMatrix(uint8_t pin)
+      : Adafruit_NeoMatrix(MATRIX_WIDTH, MATRIX_HEIGHT, pin,
+                           NEO_MATRIX_TOP  + NEO_MATRIX_LEFT +
+                           NEO_MATRIX_ROWS + NEO_MATRIX_ZIGZAG,
+                           NEO_GRB         + NEO_KHZ800),
+        _channelSum(0),
+        _scale(256),
+        _maxBrightness(0),
+        _frameMilliamps(0),
+        _showMicros(0)
+    {
+      setRemapFunction(pixelIndex);
+      fillLevels();
+    }
+
+    // Packs a color the same way as Color(), but at compile time
+    static constexpr uint16_t color(uint8_t r, uint8_t g, uint8_t b) {
+      return (uint16_t(r & 0xF8) << 8) | (uint16_t(g & 0xFC) << 3) | (b >> 3);
+    }
+
+    // Mixes two colors, weight 0 giving all of the first and 256 all of
+    // the second
+    static uint16_t blend(uint16_t under, uint16_t over, uint16_t weight) {
+      uint16_t r = ((under >> 11) * (256 - weight) + (over >> 11) * weight) >> 8;
+      uint16_t g = (((under >> 5) & 0x3F) * (256 - weight) + ((over >> 5) & 0x3F) * weight) >> 8;
+      uint16_t b = ((under & 0x1F) * (256 - weight) + (over & 0x1F) * weight) >> 8;
+      return (r << 11) | (g << 5) | b;
+    }
+
+    // The strip is wired in rows from the top left, alternating direction
+    static uint16_t pixelIndex(uint16_t x, uint16_t y) {
+      return y * MATRIX_WIDTH + ((y & 1) ? MATRIX_WIDTH - 1 - x : x);
+    }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) {
+      if (x < 0 || y < 0 || x >= MATRIX_WIDTH || y >= MATRIX_HEIGHT) return;
+
+      uint16_t index = pixelIndex(x, y);
+      uint8_t* pixel = getPixels() + index * 3;
+      _channelSum -= pixel[0] + pixel[1] + pixel[2];
+
+      uint8_t threshold = pgm_read_byte(&ditherTable[(y & 3) * 4 + (x & 3)]);
+
+      // The strip takes green, red, blue
+      pixel[0] = level(_levels6[(color >> 5) & 0x3F], threshold);
+      pixel[1] = level(_levels5[color >> 11], threshold);
+      pixel[2] = level(_levels5[color & 0x1F], threshold);
+
+      _channelSum += pixel[0] + pixel[1] + pixel[2];
+#ifdef MIRROR
+      _mirror.changed(index);
+#endif
+    }
+
+    void fillScreen(uint16_t color) {
+      for (int16_t y = 0; y < MATRIX_HEIGHT; ++y) {
+        for (int16_t x = 0; x < MATRIX_WIDTH; ++x) {
+          drawPixel(x, y, color);
+        }
+      }
+    }
+
+    void clear() {
+      Adafruit_NeoMatrix::clear();
+      _channelSum = 0;
+#ifdef MIRROR
+      _mirror.changedAll();
+#endif
+    }
+
+    // Sets the brightness used whenever the power budget allows it
+    void setBrightness(uint8_t brightness) {
+      _maxBrightness = brightness;
+      scaleBrightness(brightness);
+    }
+
+    uint8_t getBrightness() const {
+      return _scale - 1;
+    }
+
+    void show() {
+      limitPower();
+      _frameMilliamps = estimatedMilliamps();
+
+      // Sending the frame keeps interrupts off nearly the whole time, so
+      // it's timed on Timer1, which doesn't need them
+      uint32_t start = cycleTimer.micros();
+      Adafruit_NeoMatrix::show();
+      _showMicros = cycleTimer.micros() - start;
+
+#ifdef MIRROR
+      _mirror.shown();
+      mirror();
+#endif
+    }
+
+#ifdef MIRROR
+    // Sends frame changes the serial port had no room for when they were
+    // shown. Called from the main loop so they go out while the frame is
+    // still.
+    void mirror() {
+      _mirror.send(getPixels(), getBrightness());
+    }
+#endif
+
+    // Estimated current drawn by the framebuffer as it stands
+    uint16_t estimatedMilliamps() {
+      return numPixels() * IDLE_MA + _channelSum * CHANNEL_MA / 255;
+    }
+
+    // Estimated current drawn by the last frame shown
+    uint16_t frameMilliamps() {
+      return _frameMilliamps;
+    }
+
+    // How long the last show() took, nearly all of it with interrupts off
+    uint16_t showMicros() {
+      return _showMicros;
+    }
+
+  protected:
+    // A channel at full value draws about 20 mA, and each pixel about 1 mA
+    // when dark.
+    static const uint32_t CHANNEL_MA = 20;
+    static const uint16_t IDLE_MA = 1;
+
+    void limitPower() {
+      uint8_t brightness = getBrightness();
+      uint16_t channelBudget = POWER_BUDGET_MA - numPixels() * IDLE_MA;
+      uint32_t channelMilliamps = _channelSum * CHANNEL_MA / 255;
+
+      if (channelMilliamps > channelBudget) {
+        // Channel values scale with brightness, so scale it by the overshoot
+        scaleBrightness(max(1, uint32_t(brightness) * channelBudget / channelMilliamps));
+
+      } else if (brightness < _maxBrightness && brightness > 0) {
+        // Go back to full brightness once the frame would fit with room to
+        // spare, so the brightness doesn't flicker around the limit.
+        uint32_t fullMilliamps = channelMilliamps * _maxBrightness / brightness;
+        if (fullMilliamps < channelBudget * 9UL / 10) {
+          scaleBrightness(_maxBrightness);
+        }
+      }
+    }
+
+    // The byte for a table entry, rounding up when the fraction left is
+    // over the dither threshold
+    static uint8_t level(uint16_t scaled, uint8_t threshold) {
+      return (scaled >> 8) + ((scaled & 0xFF) > threshold);
+    }
+
+    // Scales the gamma tables by the brightness into _levels5 and _levels6
+    void fillLevels() {
+      for (byte i = 0; i < 32; ++i) {
+        _levels5[i] = (uint32_t(pgm_read_word(&gammaTable5[i])) * _scale) >> 8;
+      }
+      for (byte i = 0; i < 64; ++i) {
+        _levels6[i] = (uint32_t(pgm_read_word(&gammaTable6[i])) * _scale) >> 8;
+      }
+    }
+
+    // Changing the brightness redraws what's already in the framebuffer at
+    // the new scale. Each byte is traced back to the color level that would
+    // have drawn nearest to it at the old scale, which is drawn again,
+    // rounded to the nearest step rather than dithered. Dithering would
+    // push a level traced from a byte rounded up a step higher again, so
+    // going back and forth, as the power limit does, would walk dim shades
+    // away; rounded, they settle after the first time. Bytes are traced
+    // through the old tables first, holding the level in their place, and
+    // then drawn from the new ones. The total has to be recomputed after.
+    void scaleBrightness(uint8_t brightness) {
+      uint16_t scale = brightness + 1;
+      if (scale != _scale) {
+        // The board is mostly runs of a few colors, so each channel keeps
+        // the last byte it traced, and what it became, to skip the search.
+        // Dark stays dark.
+        uint8_t from[3] = { 0, 0, 0 };
+        uint8_t to[3] = { 0, 0, 0 };
+        uint8_t* pixels = getPixels();
+        for (uint16_t i = 0; i < numPixels() * 3; ++i) {
+          byte channel = i % 3;
+          if (pixels[i] != from[channel]) {
+            from[channel] = pixels[i];
+            to[channel] = channel == 0 ? source(_levels6, 64, pixels[i]) : source(_levels5, 32, pixels[i]);
+          }
+          pixels[i] = to[channel];
+        }
+
+        _scale = scale;
+        fillLevels();
+        for (uint16_t i = 0; i < numPixels() * 3; ++i) {
+          pixels[i] = level(i % 3 == 0 ? _levels6[pixels[i]] : _levels5[pixels[i]], 127);
+        }
+      }
+      sumChannels();
+#ifdef MIRROR
+      _mirror.changedAll();
+#endif
+    }
+
+    // The entry of a table of levels that draws nearest to value, by binary
+    // search, since the table rises
+    static uint8_t source(const uint16_t* levels, uint8_t size, uint8_t value) {
+      uint16_t target = uint16_t(value) << 8;
+      uint8_t low = 0;
+      uint8_t high = size - 1;
+      while (low < high) {
+        uint8_t middle = (low + high) / 2;
+        if (levels[middle] < target) {
+          low = middle + 1;
+        } else {
+          high = middle;
+        }
+      }
+
+      // low is the first entry at or past the value; the one before may be
+      // nearer
+      if (low > 0 && target - levels[low - 1] < levels[low] - target) {
+        --low;
+      }
+      return low;
+    }
+
+    void sumChannels() {
+      const uint8_t* pixels = getPixels();
+      _channelSum = 0;
+      for (uint16_t i = 0; i < numPixels() * 3; ++i) {
+        _channelSum += pixels[i];
+      }
+    }
+
+    uint32_t _channelSum;
+    uint16_t _scale; // Brightness + 1, so 256 is full
+    uint8_t _maxBrightness;
+    uint16_t _levels5[32]; // The gamma tables at the brightness, 192 bytes
+    uint16_t _levels6[64]; // of RAM that save a 32 bit multiply per channel
+    uint16_t _frameMilliamps;
+    uint16_t _showMicros;
+#ifdef MIRROR
+    FrameMirror<MATRIX_WIDTH * MATRIX_HEIGHT> _mirror;
+#endif
+};
+
+#endif
@@ -0,0 +1,125 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _FRAMEMIRROR_HPP_
+#define _FRAMEMIRROR_HPP_
+
+#include "CycleTimer.hpp"
+#include "Telemetry.hpp"
+
+// Uncomment to mirror the frames shown on the LEDs over telemetry, for
+// tools/mirror.py
+// #define MIRROR
+
+// Millis between keyframes, which resend every pixel so a viewer can start
+// at any time
+#define MIRROR_KEYFRAME_INTERVAL 5000
+
+// Most pixels sent in one Record_Pixels
+#define MIRROR_RUN ((TELEMETRY_MAX_PAYLOAD - 1) / 3)
+
+// Mirrors the frames shown on a strip of PIXELS LEDs as telemetry. Pixels
+// drawn since they were last sent are kept in a bit set, and each call to
+// send() sends as many runs of them as fit in the serial transmit buffer,
+// so it never waits. A frame record follows once all are sent. When frames
+// change faster than the serial port can carry them, their changes merge
+// and the viewer shows fewer frames instead of the game slowing down.
+template <uint16_t PIXELS>
+class FrameMirror {
+  static_assert(PIXELS <= 256, "Pixel runs are addressed with a byte");
+
+  public:
+    FrameMirror()
+      : _frame(0),
+        _pending(false),
+        _keyframe(false),
+        _lastKeyframeTm(0)
+    {
+      changedAll();
+    }
+
+    // Pixel i of the strip was drawn
+    void changed(byte i) {
+      _dirty[i >> 3] |= 1 << (i & 7);
+      _pending = true;
+    }
+
+    void changedAll() {
+      memset(_dirty, 0xFF, sizeof(_dirty));
+      _pending = true;
+    }
+
+    // A frame was shown
+    void shown() {
+      ++_frame;
+    }
+
+    // Sends what fits of the changes, from the strip's buffer of 3 bytes
+    // per pixel
+    void send(const uint8_t* pixels, uint8_t brightness) {
+      if (cycleTimer.millis() - _lastKeyframeTm >= MIRROR_KEYFRAME_INTERVAL) {
+        _lastKeyframeTm = cycleTimer.millis();
+        _keyframe = true;
+        changedAll();
+      }
+
+      if (!_pending) return;
+
+      uint16_t i = 0;
+      while (true) {
+        while (i < PIXELS && !isDirty(i)) {
+          // Bytes with no changed pixels are skipped whole
+          i = _dirty[i >> 3] ? i + 1 : (i | 7) + 1;
+        }
+        if (i >= PIXELS) break;
+
+        byte room = telemetry.room();
+        if (room < 4) return; // Not even one pixel fits, so the rest waits
+
+        byte count = 0;
+        byte most = min(MIRROR_RUN, (room - 1) / 3);
+        while (i + count < PIXELS && count < most && isDirty(i + count)) {
+          _dirty[(i + count) >> 3] &= ~(1 << ((i + count) & 7));
+          ++count;
+        }
+
+        telemetry.pixels(i, pixels + i * 3, count);
+        i += count;
+      }
+
+      // Waiting for room rather than counting the frame record dropped
+      if (telemetry.room() >= 4 && telemetry.frame(_frame, brightness, _keyframe)) {
+        _pending = false;
+        _keyframe = false;
+      }
+    }
+
+  protected:
+    bool isDirty(uint16_t i) {
+      return _dirty[i >> 3] & (1 << (i & 7));
+    }
+
+    byte _dirty[(PIXELS + 7) / 8]; // Pixels drawn since they were sent
+    uint16_t _frame;               // Frames shown
+    bool _pending;                 // Changes or the frame record left to send
+    bool _keyframe;                // Every pixel is being resent
+    uint32_t _lastKeyframeTm;
+};
+
+#endif
@@ -0,0 +1,172 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _FUZZER_HPP_
+#define _FUZZER_HPP_
+
+#include "BoardController.hpp"
+#include "Random.hpp"
+
+// Segments in each sequence, at most 8 so they fit the bit mask
+#define FUZZ_SEGMENTS 8
+
+// Physics steps in each segment
+#define FUZZ_SEGMENT_STEPS 50
+
+// Strongest tilt fed to the physics, in radians
+#define FUZZ_MAX_TILT 1.5
+
+#define FUZZ_PASSED 0xFFFF
+
+// Plays a level with a random and adversarial tilt sequence, checking the
+// physics invariants after every step. A sequence that breaks one is
+// shrunk to the smallest that still does: segments are dropped until none
+// can be, then the last one left is cut short.
+//
+// The physics is driven directly rather than through update(), so a seed
+// replays exactly and the sensors and clock play no part. It runs on a
+// host, where a sequence takes microseconds instead of the seconds its
+// animations take on the board; see test/FuzzTest.cpp and test/fuzz.sh.
+class Fuzzer {
+  public:
+    Fuzzer(BoardController<>& controller)
+      : _controller(controller)
+    {
+    }
+
+    // Plays the seed's tilt sequence on the level. Returns FUZZ_PASSED if
+    // no invariant broke. Otherwise shrinks the sequence, setting segments
+    // to the fewest that still break one and steps to how many steps of
+    // the last of them are needed, and returns the step where the shrunk
+    // sequence breaks one.
+    uint16_t check(byte level, uint16_t seed, byte& segments, byte& steps) {
+      segments = (1 << FUZZ_SEGMENTS) - 1;
+      steps = FUZZ_SEGMENT_STEPS;
+      uint16_t step = play(level, seed, segments, steps);
+      if (step == FUZZ_PASSED) return step;
+
+      // Without one segment the balls are elsewhere when the next starts,
+      // so one that was needed may not be anymore. Passes repeat until
+      // none can be dropped. Any after the failing step go in the first.
+      bool dropped = true;
+      while (dropped) {
+        dropped = false;
+        for (byte s = 0; s < FUZZ_SEGMENTS; ++s) {
+          byte fewer = segments & ~(1 << s);
+          if (fewer == segments) continue;
+
+          uint16_t fewerStep = play(level, seed, fewer, steps);
+          if (fewerStep != FUZZ_PASSED) {
+            segments = fewer;
+            step = fewerStep;
+            dropped = true;
+          }
+        }
+      }
+      if (segments == 0) return step; // Breaks with the board held level
+
+      // Bisects the last segment's steps for the fewest that still break
+      // one. Fewer steps of it passing and more failing is assumed.
+      byte passing = 0;
+      while (steps - passing > 1) {
+        byte middle = passing + (steps - passing) / 2;
+        uint16_t middleStep = play(level, seed, segments, middle);
+        if (middleStep != FUZZ_PASSED) {
+          steps = middle;
+          step = middleStep;
+        } else {
+          passing = middle;
+        }
+      }
+      return step;
+    }
+
+  protected:
+    enum SegmentKind {
+      Segment_Hold,  // A steady random tilt
+      Segment_Slam,  // Full tilt toward one of the eight neighbors
+      Segment_Flip,  // Full tilt, reversing every step
+      Segment_Noise  // A new random tilt every step
+    };
+
+    // Plays the level from its start with the segments in the mask, the
+    // last of them for only its first lastSteps steps, holding the board
+    // level in place of the rest. Returns the step of the first invariant
+    // broken, or FUZZ_PASSED.
+    uint16_t play(byte level, uint16_t seed, byte segments, byte lastSteps) {
+      _controller.setTrapCount(0);
+      _controller.setLevel(level);
+
+      uint16_t step = 0;
+      for (byte s = 0; s < FUZZ_SEGMENTS; ++s) {
+        bool enabled = segments & (1 << s);
+        bool last = enabled && (segments >> s) == 1;
+
+        // Each segment has its own generator, so dropping one leaves the
+        // others unchanged
+        _random.seed(seed * FUZZ_SEGMENTS + s + 1);
+        _random.next(); // Spread the nearby seeds apart
+        byte kind = _random.next() & 3;
+        float dirX = direction();
+        float dirY = direction();
+        float holdX = tilt();
+        float holdY = tilt();
+
+        for (byte i = 0; i < FUZZ_SEGMENT_STEPS; ++i, ++step) {
+          float x = 0.0;
+          float y = 0.0;
+          if (enabled && !(last && i >= lastSteps)) {
+            switch (kind) {
+              case Segment_Hold : x = holdX; y = holdY; break;
+              case Segment_Slam : x = dirX * FUZZ_MAX_TILT; y = dirY * FUZZ_MAX_TILT; break;
+              case Segment_Flip : {
+                float sign = (i & 1) ? -FUZZ_MAX_TILT : FUZZ_MAX_TILT;
+                x = dirX * sign;
+                y = dirY * sign;
+                break;
+              }
+              case Segment_Noise: x = tilt(); y = tilt(); break;
+            }
+          }
+
+          _controller.simulateStep(x, y);
+          if (_controller.checkInvariants()) {
+            return step;
+          }
+        }
+      }
+
+      return FUZZ_PASSED;
+    }
+
+    // A random tilt between -FUZZ_MAX_TILT and FUZZ_MAX_TILT
+    float tilt() {
+      return (int((_random.next() >> 8) & 0xFF) - 128) * (FUZZ_MAX_TILT / 128);
+    }
+
+    // -1, 0 or 1
+    float direction() {
+      return float(_random.next() % 3) - 1.0;
+    }
+
+    BoardController<>& _controller;
+    Random _random;
+};
+
+#endif
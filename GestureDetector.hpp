@@ -0,0 +1,187 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _GESTUREDETECTOR_HPP_
+#define _GESTUREDETECTOR_HPP_
+
+#include "CycleTimer.hpp"
+#include "Telemetry.hpp"
+
+// Motion is the sum over the axes of how far a sample is from a slowly
+// following average, in milli-g.
+
+// A tap is motion over TAP_THRESHOLD that dies down within TAP_MAX_LENGTH
+// millis. Two taps from TAP_MIN_GAP to TAP_MAX_GAP millis apart skip the
+// level. A knuckle on the frame leaves it ringing for a few tens of
+// millis, while the quickest tilt by hand takes over 150, so the limit
+// sits between them, with a sample or two to spare for the average to
+// settle after a tap.
+#define TAP_THRESHOLD 350
+#define TAP_MAX_LENGTH 60
+#define TAP_MIN_GAP 100
+#define TAP_MAX_GAP 500
+
+// Each sample with motion over SHAKE_THRESHOLD adds 3 to the shake score,
+// and each one under takes 1 away. Reaching SHAKE_SCORE restarts the level.
+#define SHAKE_THRESHOLD 600
+#define SHAKE_SCORE 30
+
+// Motion under STILL_THRESHOLD for STILL_TIME millis means the board has
+// been put down. Only attract mode acts on it, sleeping after the demo has
+// played that long; play reaches attract mode after its own idle timeout.
+#define STILL_THRESHOLD 50
+#define STILL_TIME 20000
+
+// Millis after a gesture when no other is recognized
+#define GESTURE_REFRACTORY 1000
+
+enum Gesture {
+  Gesture_None,
+  Gesture_Shake,
+  Gesture_DoubleTap,
+  Gesture_Still
+};
+
+// Recognizes gestures in the stream of accelerometer samples. Each sample
+// takes constant time, and the whole state is under 20 bytes.
+class GestureDetector {
+  public:
+    GestureDetector() {
+      reset();
+    }
+
+    // Forgets the samples so far, for when the stream has had a gap
+    void reset() {
+      _primed = false;
+      _inSpike = false;
+      _stillReported = false;
+      _refractory = false;
+      _shakeScore = 0;
+      _lastTapTm = 0;
+      _pending = Gesture_None;
+    }
+
+    void sample(int x, int y, int z) {
+      uint32_t now = cycleTimer.millis();
+
+      if (!_primed) {
+        _average[0] = x * 8;
+        _average[1] = y * 8;
+        _average[2] = z * 8;
+        _stillSinceTm = now;
+        _primed = true;
+        return;
+      }
+
+      int motion = follow(0, x) + follow(1, y) + follow(2, z);
+
+      // Samples keep coming, so expiring the short intervals as they pass
+      // keeps the truncated millis from wrapping around into a match
+      if (_refractory && uint16_t(uint16_t(now) - _refractoryTm) >= GESTURE_REFRACTORY) {
+        _refractory = false;
+      }
+      if (_lastTapTm != 0 && uint16_t(uint16_t(now) - _lastTapTm) > TAP_MAX_GAP) {
+        _lastTapTm = 0;
+      }
+
+      if (motion >= STILL_THRESHOLD) {
+        _stillSinceTm = now;
+        _stillReported = false;
+      } else if (!_stillReported && now - _stillSinceTm >= STILL_TIME) {
+        _stillReported = true;
+        recognize(Gesture_Still, now);
+      }
+
+      // The rest of a shake that was just recognized doesn't count toward
+      // another
+      if (_refractory) {
+        _shakeScore = 0;
+      } else if (motion > SHAKE_THRESHOLD) {
+        _shakeScore = min(255, _shakeScore + 3);
+      } else if (_shakeScore > 0) {
+        --_shakeScore;
+      }
+      if (_shakeScore >= SHAKE_SCORE) {
+        _shakeScore = 0;
+        recognize(Gesture_Shake, now);
+        return;
+      }
+
+      if (!_inSpike) {
+        if (motion > TAP_THRESHOLD) {
+          _inSpike = true;
+          _spikeStartTm = now;
+        }
+      } else if (motion < TAP_THRESHOLD / 2) {
+        _inSpike = false;
+
+        // Long spikes are tilting, and a rising shake score means the
+        // spike is part of a shake
+        bool tap = uint16_t(uint16_t(now) - _spikeStartTm) <= TAP_MAX_LENGTH && _shakeScore <= 8;
+        if (tap && !_refractory) {
+          uint16_t gap = uint16_t(now) - _lastTapTm;
+          if (_lastTapTm != 0 && gap >= TAP_MIN_GAP) {
+            _lastTapTm = 0;
+            recognize(Gesture_DoubleTap, now);
+          } else {
+            _lastTapTm = max(1, uint16_t(now));
+          }
+        }
+      }
+    }
+
+    // Returns the gesture recognized since the last call, if any
+    Gesture take() {
+      Gesture g = Gesture(_pending);
+      _pending = Gesture_None;
+      return g;
+    }
+
+  protected:
+    // Moves an axis's average an eighth of the way to the sample, and
+    // returns how far the sample was from it
+    int follow(byte axis, int value) {
+      int difference = value - _average[axis] / 8;
+      _average[axis] += difference;
+      return abs(difference);
+    }
+
+    void recognize(Gesture g, uint32_t now) {
+      _pending = g;
+      _refractory = true;
+      _refractoryTm = now;
+      telemetry.gesture(g);
+    }
+
+    int16_t _average[3];    // Running averages of the axes, times 8
+    uint32_t _stillSinceTm;
+    uint16_t _spikeStartTm; // Short intervals keep only the low bits of the time
+    uint16_t _lastTapTm;    // 0 when there's no first tap waiting for a second
+    uint16_t _refractoryTm;
+    byte _shakeScore;
+    byte _pending;
+    bool _primed : 1;
+    bool _inSpike : 1;
+    bool _stillReported : 1;
+    bool _refractory : 1;
+};
+
+GestureDetector gestures;
+
+#endif
@@ -0,0 +1,35 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _INPUTPROVIDER_HPP_
+#define _INPUTPROVIDER_HPP_
+
+// Where the tilt that rolls the balls comes from: the accelerometer, or a
+// player standing in for the person holding the board.
+class InputProvider {
+  public:
+    // Takes a new reading, once per BoardController::update()
+    virtual void update() = 0;
+
+    // Tilt along the X and Y axes, in radians
+    virtual float x() = 0;
+    virtual float y() = 0;
+};
+
+#endif
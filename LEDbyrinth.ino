@@ -15,56 +15,173 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include "Autoplayer.hpp"
+#include "Benchmark.hpp"
 #include "BoardController.hpp"
+#include "CycleTimer.hpp"
+#include "MemoryProbe.hpp"
 #include "Orientation.hpp"
-#include "Screensaver.hpp"
+#include "Progress.hpp"
+#include "TiltEstimator.hpp"
 
 #include <avr/sleep.h>
 #include <avr/wdt.h>
 
+// Number of balls each level starts with, up to MAX_BALLS. Shaking the
+// board on level 0, the level select, switches to MULTI_BALL_COUNT and
+// back.
+#define BALL_COUNT 1
+#define MULTI_BALL_COUNT MAX_BALLS
+
+// Uncomment to report cycle counts for the hot paths over telemetry at startup
+// #define BENCHMARK
+
+byte ballCount = BALL_COUNT; // Chosen on level 0, kept until power off
+
 PictureFrame pictureFrame;
-BoardController controller(pictureFrame.matrix(), accelerometer, levels);
+BoardController<> controller(pictureFrame.matrix(), tilt, levels);
+Autoplayer autoplayer(controller, tilt);
 
 void setup() {
+  memoryProbe.paint();
+
   // Required because powering AREF pin - analogRead will short otherwise
   analogReference(EXTERNAL);
 
   pinMode(LED_BUILTIN, OUTPUT);
-  Serial.begin(9600);
+  telemetry.begin();
+  cycleTimer.begin();
 
   pictureFrame.enable();
-  controller.reset();
+  tilt.calibrate(); // However the board is held at power on is level
+  controller.setBallCount(ballCount);
+
+#ifdef BENCHMARK
+  Benchmark(controller, pictureFrame.matrix(), levels, autoplayer).run();
+#endif
+
+  // Pick up where the player left off
+  progress.load();
+  resumeLevel();
+}
+
+void resumeLevel() {
+  controller.setTrapCount(progress.trapCount());
+#ifdef ENDLESS_MAZES
+  // Indexes past the stored levels are generated mazes, so any is playable
+  controller.setLevel(progress.level());
+#else
+  controller.setLevel(progress.level() < levels.count ? progress.level() : 1);
+#endif
 }
 
 uint32_t lastBoardChangeTm = 0;
-uint32_t screensaverTimeout = 30000; // millis
+uint32_t attractTimeout = 30000; // millis
 uint32_t sleepTimeout = 300000; // millis
+uint32_t lastReportTm = 0;
+uint32_t reportInterval = 1000; // millis
 
 void loop() {
 
   bool didChange = controller.update();
-  if (didChange) {
-    lastBoardChangeTm = millis();
-
-  } else if (millis() - lastBoardChangeTm > screensaverTimeout) {
-    Orientation orientation(0.5);
-
-    while (!orientation.changed()) {
-      if (millis() - lastBoardChangeTm < sleepTimeout) {
-        pictureFrame.screenSaverUpdate();
-      } else {
-        // Deep sleep
-        pictureFrame.disable();
-        while (!orientation.changed()) {
-          powerSave();
-        }
-        pictureFrame.enable();
-        break;
+
+#ifdef MIRROR
+  pictureFrame.matrix().mirror();
+#endif
+
+  if (cycleTimer.millis() - lastReportTm > reportInterval) {
+    telemetry.memory(memoryProbe.free(), memoryProbe.unused());
+    telemetry.clock(pictureFrame.matrix().showMicros(), cycleTimer.millisDrift());
+    lastReportTm = cycleTimer.millis();
+  }
+
+  switch (gestures.take()) {
+    case Gesture_Shake:
+      if (controller.levelIndex() == 0) {
+        ballCount = ballCount == BALL_COUNT ? MULTI_BALL_COUNT : BALL_COUNT;
+        controller.setBallCount(ballCount);
       }
+      controller.setLevel(controller.levelIndex());
+      didChange = true;
+      break;
+    case Gesture_DoubleTap:
+      // Skips ahead only to a level the player has reached before
+      if (progress.unlocked(controller.followingLevel())) {
+        controller.nextLevel();
+        didChange = true;
+      }
+      break;
+    default:
+      // A board left still reaches attract mode first, which sleeps
+      break;
+  }
+
+  if (didChange) {
+    lastBoardChangeTm = cycleTimer.millis();
+    // Saved as the level changes. The trap count, which changes with every
+    // trap hit, waits until the board is left alone.
+    if (controller.levelIndex() != progress.level()) {
+      progress.save(controller.levelIndex(), controller.trapCount());
     }
-    controller.setLevel(1);
-    lastBoardChangeTm = millis();
+
+  } else if (cycleTimer.millis() - lastBoardChangeTm > attractTimeout) {
+    progress.save(controller.levelIndex(), controller.trapCount());
+    attract();
+    resumeLevel();
+    lastBoardChangeTm = cycleTimer.millis();
+  }
+}
+
+// Demos the levels until the board is tilted, a gesture is made, or it's
+// time to sleep. Progress isn't saved, so the player's level is resumed
+// after.
+void attract() {
+  controller.setBallCount(1);
+  controller.setInput(autoplayer);
+  autoplayer.start();
+
+  // The board has been idle a while, so it may have been still long
+  // enough already. Start timing afresh, so the demo plays for at least
+  // STILL_TIME before a still board sleeps.
+  gestures.reset();
+
+  while (!autoplayer.interrupted()) {
+    if (cycleTimer.millis() - lastBoardChangeTm >= sleepTimeout) {
+      deepSleep();
+      break;
+    }
+
+    controller.update();
+    if (autoplayer.demoOver()) {
+      autoplayer.nextDemo();
+    }
+
+    Gesture gesture = gestures.take();
+    if (gesture == Gesture_Still) {
+      deepSleep();
+      break;
+    } else if (gesture != Gesture_None) {
+      break;
+    }
+  }
+
+  autoplayer.stop();
+  controller.setInput(tilt);
+  controller.setBallCount(ballCount);
+}
+
+// Turns off the frame until the board is picked up
+void deepSleep() {
+  Orientation orientation(0.5);
+
+  pictureFrame.disable();
+  while (!orientation.changed()) {
+    powerSave();
   }
+  pictureFrame.enable();
+
+  // The samples from before sleeping say nothing about the motion now
+  gestures.reset();
 }
 
 /*
@@ -20,6 +20,8 @@
 #ifndef _LEVELS_HPP_
 #define _LEVELS_HPP_
 
+#include "FrameMatrix.hpp"
+
 const byte Cell_Empty = 0;
 const byte Cell_Wall = 1;
 const byte Cell_Trap = 2;
@@ -32,14 +34,78 @@ const byte Cell_WarpBase = 20;
 const byte Cell_PointerBase = 35;
 // Cell values from PointerBase up are used as pointers for teleports within a level.
 
-// Implements a Compressed Sparse Row matrix of byte values.
+const byte Element_Door = 0;   // A wall that opens and closes on a timer or when switched
+const byte Element_Switch = 1; // Toggles a door when a ball rolls onto it
+const byte Element_Mover = 2;  // A wall that slides back and forth
+
+// Most dynamic elements a level can have
+#define MAX_ELEMENTS 4
+
+// A part of a level that changes during play. Elements are stored in
+// PROGMEM and cover cells that are empty in the level's cell data.
+struct LevelElement {
+  byte kind;
+  byte x;       // Top left cell
+  byte y;
+  byte width;   // Size in cells
+  byte height;
+  byte period;  // Doors and movers: tenths of a second between changes, 0 for never.
+                // Switches: index of the door they toggle.
+  int8_t dx;    // Movers: cells moved each change
+  int8_t dy;
+  byte travel;  // Movers: moves made before reversing
+};
+
+template <byte WIDTH, byte HEIGHT>
+class MazeLevel;
+
+// Implements a Compressed Sparse Row matrix of byte values for a board of
+// WIDTH x HEIGHT. Levels are stored in PROGMEM and copied into RAM one at a
+// time to be played. The constructors take the level's arrays by reference
+// so their sizes can be checked against the board's. A level can also play
+// a MazeLevel generated in RAM.
+template <byte WIDTH = MATRIX_WIDTH, byte HEIGHT = MATRIX_HEIGHT>
 class Level {
   public:
-    Level(byte startX_, byte startY_, const byte *rowIndices, const byte *columnIndices, const byte *values)
-      : startX(startX_), startY(startY_), _rowIndices(rowIndices), _columnIndices(columnIndices), _values(values)
-    { }
+    template <size_t ROWS, size_t COLUMNS, size_t VALUES>
+    constexpr Level(byte startX_, byte startY_, const byte (&rowIndices)[ROWS],
+                    const byte (&columnIndices)[COLUMNS], const byte (&values)[VALUES])
+      : startX(startX_), startY(startY_), elementCount(0),
+        _rowIndices(rowIndices), _columnIndices(columnIndices), _values(values), _elements(0), _maze(0)
+    {
+      static_assert(ROWS == HEIGHT + 1, "Level needs a row index for each row of the board, plus one");
+      static_assert(COLUMNS == VALUES, "Level needs a column index for each value");
+      static_assert(COLUMNS <= WIDTH * HEIGHT, "Level has more values than the board has cells");
+    }
+
+    template <size_t ROWS, size_t COLUMNS, size_t VALUES, size_t ELEMENTS>
+    constexpr Level(byte startX_, byte startY_, const byte (&rowIndices)[ROWS],
+                    const byte (&columnIndices)[COLUMNS], const byte (&values)[VALUES],
+                    const LevelElement (&elements)[ELEMENTS])
+      : startX(startX_), startY(startY_), elementCount(ELEMENTS),
+        _rowIndices(rowIndices), _columnIndices(columnIndices), _values(values), _elements(elements), _maze(0)
+    {
+      static_assert(ROWS == HEIGHT + 1, "Level needs a row index for each row of the board, plus one");
+      static_assert(COLUMNS == VALUES, "Level needs a column index for each value");
+      static_assert(COLUMNS <= WIDTH * HEIGHT, "Level has more values than the board has cells");
+      static_assert(ELEMENTS <= MAX_ELEMENTS, "Level has more elements than MAX_ELEMENTS");
+    }
+
+    Level(const MazeLevel<WIDTH, HEIGHT>* maze, byte startX_, byte startY_)
+      : startX(startX_), startY(startY_), elementCount(0),
+        _rowIndices(0), _columnIndices(0), _values(0), _elements(0), _maze(maze)
+    {
+    }
+
+    Level() { }
+
+    // Cells off the board are walls. Callers pass ints, so negative
+    // coordinates wrap around to bytes past the board and are caught by
+    // the same check, like DistanceMap::code()'s.
+    byte cellAt(byte x, byte y) {
+      if (x >= WIDTH || y >= HEIGHT) return Cell_Wall;
+      if (_maze) return _maze->cellAt(x, y);
 
-    byte cellAt(int x, int y) {
       // Row y's column indices start at columnIndices[rowIndices[y]] and
       // its values start at values[rowIndices[y]]
       byte rowStartIndex = pgm_read_byte_near(_rowIndices + y);
@@ -54,15 +120,22 @@ class Level {
       return Cell_Empty;
     }
 
-    Level* next = 0;
+    LevelElement element(byte i) {
+      LevelElement e;
+      memcpy_P(&e, _elements + i, sizeof(LevelElement));
+      return e;
+    }
 
-    const byte startX;
-    const byte startY;
+    byte startX;
+    byte startY;
+    byte elementCount;
 
   protected:
     const byte* _rowIndices;
     const byte* _columnIndices;
     const byte* _values;
+    const LevelElement* _elements;
+    const MazeLevel<WIDTH, HEIGHT>* _maze; // In RAM, for generated levels
 };
 
 const byte level1_rowIndices[] PROGMEM = { 0, 3, 5, 7, 10, 14, 18, 22, 26, 29, 37, 37, 37, 37 };
@@ -87,6 +160,12 @@ const byte level2_values[] PROGMEM = {
   Cell_Wall, Cell_Wall, Cell_Wall, Cell_Wall, Cell_Wall, Cell_Wall, Cell_PointerBase + 16,
   Cell_Wall, Cell_Wall, Cell_Exit
 };
+const LevelElement level2_elements[] PROGMEM = {
+  { Element_Mover,  2, 10, 3, 1,  3, 1, 0, 10 }, // Sweeps across row 10
+  { Element_Door,  16, 11, 1, 1, 15, 0, 0,  0 }, // Opens and closes by itself
+  { Element_Door,  15, 12, 1, 1,  0, 0, 0,  0 }, // Only opened by the switch
+  { Element_Switch, 8,  0, 1, 1,  2, 0, 0,  0 },
+};
 
 const byte puzzleLevel1_rowIndices[] PROGMEM = { 0, 7, 16, 20, 27, 34, 43, 51, 58, 68, 76, 83, 90, 98 };
 const byte puzzleLevel1_columnIndices[] PROGMEM = {
@@ -382,30 +461,40 @@ const byte winnerLevel_values[] PROGMEM = {
   Cell_Wall, Cell_Wall, Cell_Wall, Cell_Wall, Cell_Wall, Cell_Wall, Cell_Exit
 };
 
+template <byte WIDTH = MATRIX_WIDTH, byte HEIGHT = MATRIX_HEIGHT>
 struct LevelSet {
-  Level *levels;
+  const Level<WIDTH, HEIGHT> *levels; // In PROGMEM
   byte count;
 
-  LevelSet(Level* levels_, int count_)
-    : levels(levels_), count(count_)
-  { }
+  template <size_t COUNT>
+  LevelSet(const Level<WIDTH, HEIGHT> (&levels_)[COUNT])
+    : levels(levels_), count(COUNT)
+  {
+    static_assert(COUNT <= Cell_PointerBase - Cell_WarpBase, "Warp cells can't reach every level");
+  }
+
+  Level<WIDTH, HEIGHT> level(byte i) {
+    Level<WIDTH, HEIGHT> l;
+    memcpy_P(&l, levels + i, sizeof(l));
+    return l;
+  }
 };
 
-Level levelsArr[] = {
-  Level(8, 6, level0_rowIndices, level0_columnIndices, level0_values),
-  Level(8, 6, level1_rowIndices, level1_columnIndices, level1_values),
-  Level(8, 6, level2_rowIndices, level2_columnIndices, level2_values),
-  Level(4, 6, effigyLevel_rowIndices, effigyLevel_columnIndices, effigyLevel_values),
-  Level(0, 12, easySpiral_rowIndices, easySpiral_columnIndices, easySpiral_values),
-  Level(8, 6, puzzleLevel1_rowIndices, puzzleLevel1_columnIndices, puzzleLevel1_values),
-  Level(7, 6, bigXlevel_rowIndices, bigXlevel_columnIndices, bigXlevel_values),
-  Level(8, 5, hardSpiral_rowIndices, hardSpiral_columnIndices, hardSpiral_values),
-  Level(8, 6, puzzleLevel2_rowIndices, puzzleLevel2_columnIndices, puzzleLevel2_values),
-  Level(8, 0, multiWarpLevel_rowIndices, multiWarpLevel_columnIndices, multiWarpLevel_values),
-  Level(0, 10, finalLevel_rowIndices, finalLevel_columnIndices, finalLevel_values),
-  Level(3, 3, winnerLevel_rowIndices, winnerLevel_columnIndices, winnerLevel_values),
+const Level<> levelsArr[] PROGMEM = {
+  Level<>(8, 6, level0_rowIndices, level0_columnIndices, level0_values),
+  Level<>(8, 6, level1_rowIndices, level1_columnIndices, level1_values),
+  Level<>(8, 6, level2_rowIndices, level2_columnIndices, level2_values, level2_elements),
+  Level<>(4, 6, effigyLevel_rowIndices, effigyLevel_columnIndices, effigyLevel_values),
+  Level<>(0, 12, easySpiral_rowIndices, easySpiral_columnIndices, easySpiral_values),
+  Level<>(8, 6, puzzleLevel1_rowIndices, puzzleLevel1_columnIndices, puzzleLevel1_values),
+  Level<>(7, 6, bigXlevel_rowIndices, bigXlevel_columnIndices, bigXlevel_values),
+  Level<>(8, 5, hardSpiral_rowIndices, hardSpiral_columnIndices, hardSpiral_values),
+  Level<>(8, 6, puzzleLevel2_rowIndices, puzzleLevel2_columnIndices, puzzleLevel2_values),
+  Level<>(8, 0, multiWarpLevel_rowIndices, multiWarpLevel_columnIndices, multiWarpLevel_values),
+  Level<>(0, 10, finalLevel_rowIndices, finalLevel_columnIndices, finalLevel_values),
+  Level<>(3, 3, winnerLevel_rowIndices, winnerLevel_columnIndices, winnerLevel_values),
 };
 
-LevelSet levels(levelsArr, 12);
+LevelSet<> levels(levelsArr);
 
 #endif
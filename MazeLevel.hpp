@@ -0,0 +1,254 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _MAZELEVEL_HPP_
+#define _MAZELEVEL_HPP_
+
+#include "Levels.hpp"
+#include "Random.hpp"
+
+// Chance in 256 that a dead end holds a trap
+#define MAZE_TRAP_CHANCE 80
+
+#define NO_ROOM 0xFF
+
+// Most moves of the maze's walk in one MazeLevel::step(). The walk makes two
+// for every room, one in and one back.
+#define MAZE_STEP_MOVES 16
+
+// A level generated from a seed: a maze of rooms on the odd cells of the
+// board, joined by opening the cells between them. The passages form a
+// tree, so every room can be reached, and the exit goes in the room
+// farthest from the start. Dead ends can hold traps, which never block the
+// way out, and one of them a teleport to another room.
+//
+// Each room keeps only the direction back toward the start, two bits a
+// room. Generating backtracks along those directions rather than keeping a
+// stack, and cellAt() works out any cell from them in constant time.
+template <byte WIDTH = MATRIX_WIDTH, byte HEIGHT = MATRIX_HEIGHT>
+class MazeLevel {
+  static_assert(WIDTH % 2 == 1 && HEIGHT % 2 == 1, "Maze rooms need a wall on every side");
+
+  public:
+    static const byte COLUMNS = (WIDTH - 1) / 2;
+    static const byte ROWS = (HEIGHT - 1) / 2;
+    static const byte ROOMS = COLUMNS * ROWS;
+
+    static_assert(ROOMS < NO_ROOM, "Too many rooms to index with a byte");
+
+    // Generates the maze for the seed and returns a level that plays it.
+    // The level reads the maze from this object.
+    Level<WIDTH, HEIGHT> generate(uint16_t seed) {
+      begin(seed);
+      while (step()) {
+      }
+      return level();
+    }
+
+    // Starts generating the maze for the seed, which step() continues, so
+    // it can be spread over the waits between frames
+    void begin(uint16_t seed) {
+      _random.seed(seed);
+      memset(_directions, 0, sizeof(_directions));
+      memset(_traps, 0, sizeof(_traps));
+      memset(_visited, 0, sizeof(_visited));
+
+      _start = _random.next() % ROOMS;
+      _exit = _start;
+      _teleport = NO_ROOM;
+
+      _room = _start;
+      _depth = 0;
+      _deepest = 0;
+      _deadEnd = true;
+      setBit(_visited, _room);
+    }
+
+    // Does the next part of generating: up to MAZE_STEP_MOVES moves of the
+    // walk, or placing the traps and the teleport once it's back at the
+    // start. Returns false once the maze is done.
+    bool step() {
+      if (_room == NO_ROOM) return false;
+
+      // A depth-first walk that carves a passage into a random unvisited
+      // neighbor, or backs up toward the start when there are none. Dead
+      // ends are collected in _traps until the exit is known.
+      for (byte moves = 0; moves < MAZE_STEP_MOVES; ++moves) {
+        byte choices[4];
+        byte count = 0;
+        for (byte d = North; d <= West; ++d) {
+          byte next = neighbor(_room, d);
+          if (next != NO_ROOM && !getBit(_visited, next)) {
+            choices[count++] = d;
+          }
+        }
+
+        if (count > 0) {
+          byte d = choices[_random.next() % count];
+          _room = neighbor(_room, d);
+          setBit(_visited, _room);
+          setDirection(_room, opposite(d));
+          _deadEnd = true;
+
+          if (++_depth > _deepest) {
+            _deepest = _depth;
+            _exit = _room;
+          }
+          continue;
+        }
+
+        if (_room == _start) {
+          placeTraps();
+          _room = NO_ROOM;
+          return false;
+        }
+
+        if (_deadEnd) {
+          setBit(_traps, _room);
+        }
+        _room = neighbor(_room, direction(_room));
+        --_depth;
+        _deadEnd = false;
+      }
+      return true;
+    }
+
+    // The level that plays the maze, once step() has finished it
+    Level<WIDTH, HEIGHT> level() {
+      return Level<WIDTH, HEIGHT>(this, roomX(_start), roomY(_start));
+    }
+
+    byte cellAt(byte x, byte y) const {
+      // The edges of the board are walls
+      if (x == 0 || y == 0 || x >= WIDTH - 1 || y >= HEIGHT - 1) return Cell_Wall;
+
+      bool roomColumn = x & 1;
+      bool roomRow = y & 1;
+
+      if (roomColumn && roomRow) return roomCell(roomAt(x, y));
+
+      // Corners between rooms
+      if (!roomColumn && !roomRow) return Cell_Wall;
+
+      // Between two rooms, open if either leads back through the other
+      byte a = roomColumn ? roomAt(x, y - 1) : roomAt(x - 1, y);
+      byte b = roomColumn ? a + COLUMNS : a + 1;
+      byte toB = roomColumn ? South : East;
+      bool open = (a != _start && direction(a) == toB) || (b != _start && direction(b) == opposite(toB));
+      return open ? Cell_Empty : Cell_Wall;
+    }
+
+  protected:
+    enum Direction { North, East, South, West };
+
+    // Some of the dead ends the walk found become traps, and one the
+    // teleport
+    void placeTraps() {
+      clearBit(_traps, _exit);
+      for (byte r = 0; r < ROOMS; ++r) {
+        if (!getBit(_traps, r)) continue;
+
+        if (_teleport == NO_ROOM && (_random.next() & 1)) {
+          _teleport = r;
+          clearBit(_traps, r);
+        } else if ((_random.next() & 0xFF) >= MAZE_TRAP_CHANCE) {
+          clearBit(_traps, r);
+        }
+      }
+
+      if (_teleport != NO_ROOM) {
+        do {
+          _destination = _random.next() % ROOMS;
+        } while (_destination == _teleport || _destination == _exit || getBit(_traps, _destination));
+      }
+    }
+
+    static byte opposite(byte d) {
+      return (d + 2) & 3;
+    }
+
+    static byte roomAt(byte x, byte y) {
+      return (y / 2) * COLUMNS + x / 2;
+    }
+
+    static byte roomX(byte room) {
+      return 1 + 2 * (room % COLUMNS);
+    }
+
+    static byte roomY(byte room) {
+      return 1 + 2 * (room / COLUMNS);
+    }
+
+    // Returns the room next to room in direction d, or NO_ROOM
+    static byte neighbor(byte room, byte d) {
+      byte column = room % COLUMNS;
+      switch (d) {
+        case North: return room >= COLUMNS ? room - COLUMNS : NO_ROOM;
+        case East : return column < COLUMNS - 1 ? room + 1 : NO_ROOM;
+        case South: return room < ROOMS - COLUMNS ? room + COLUMNS : NO_ROOM;
+        default   : return column > 0 ? room - 1 : NO_ROOM;
+      }
+    }
+
+    byte roomCell(byte room) const {
+      if (room == _exit) return Cell_Exit;
+      if (room == _teleport) return Cell_PointerBase + roomY(_destination) * WIDTH + roomX(_destination);
+      if (getBit(_traps, room)) return Cell_Trap;
+      return Cell_Empty;
+    }
+
+    // The direction from a room back toward the start
+    byte direction(byte room) const {
+      return (_directions[room >> 2] >> ((room & 3) * 2)) & 3;
+    }
+
+    void setDirection(byte room, byte d) {
+      _directions[room >> 2] |= d << ((room & 3) * 2);
+    }
+
+    static bool getBit(const byte* bits, byte i) {
+      return bits[i >> 3] & (1 << (i & 7));
+    }
+
+    static void setBit(byte* bits, byte i) {
+      bits[i >> 3] |= 1 << (i & 7);
+    }
+
+    static void clearBit(byte* bits, byte i) {
+      bits[i >> 3] &= ~(1 << (i & 7));
+    }
+
+    byte _directions[(ROOMS + 3) / 4];
+    byte _traps[(ROOMS + 7) / 8];
+    byte _start;
+    byte _exit;
+    byte _teleport;
+    byte _destination;
+    Random _random;
+
+    // The walk's place while it's generating, _room being NO_ROOM once the
+    // maze is done
+    byte _visited[(ROOMS + 7) / 8];
+    byte _room;
+    byte _depth;
+    byte _deepest;
+    bool _deadEnd;
+};
+
+#endif
@@ -0,0 +1,68 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _MEMORYPROBE_HPP_
+#define _MEMORYPROBE_HPP_
+
+// Bounds of the heap, from avr-libc's malloc
+extern char __heap_start;
+extern char* __brkval;
+
+// Byte written over the free RAM, picked to be unlikely in stack frames
+#define MEMORY_PAINT 0xC5
+
+// Measures the RAM left between the heap and the stack. paint() fills it
+// with MEMORY_PAINT, and the stack's high-water mark is wherever the
+// paint is no longer intact.
+class MemoryProbe {
+  public:
+    void paint() {
+      byte* p = heapEnd();
+      byte* stack = (byte*)SP;
+      while (p < stack) {
+        *p++ = MEMORY_PAINT;
+      }
+    }
+
+    // Bytes free between the heap and the stack right now
+    uint16_t free() {
+      return (byte*)SP - heapEnd();
+    }
+
+    // Bytes the stack has never reached since paint()
+    uint16_t unused() {
+      byte* p = heapEnd();
+      byte* stack = (byte*)SP;
+      uint16_t count = 0;
+      while (p < stack && *p == MEMORY_PAINT) {
+        ++p;
+        ++count;
+      }
+      return count;
+    }
+
+  protected:
+    byte* heapEnd() {
+      return __brkval ? (byte*)__brkval : (byte*)&__heap_start;
+    }
+};
+
+MemoryProbe memoryProbe;
+
+#endif
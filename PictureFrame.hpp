@@ -20,13 +20,11 @@
 #ifndef _PICTUREFRAME_HPP_
 #define _PICTUREFRAME_HPP_
 
-#include <Adafruit_GFX.h>
-#include <Adafruit_NeoPixel.h>
-#include <Adafruit_NeoMatrix.h>
+#include "FrameMatrix.hpp"
 
-#include "Screensaver.hpp"
-
-#define BRIGHTNESS 30
+// Colors are gamma corrected, so the palette's brightest colors look as
+// they did at 30 without it
+#define BRIGHTNESS 96
 
 // The pin the NeoPixels are on
 #define SIGNAL_PIN 6
@@ -38,14 +36,7 @@ class PictureFrame {
   public:
 
     PictureFrame() :
-      _matrix(
-        17, // width
-        13, // height
-        SIGNAL_PIN,  // control pin
-        NEO_MATRIX_TOP     + NEO_MATRIX_LEFT +
-        NEO_MATRIX_ROWS    + NEO_MATRIX_ZIGZAG,
-        NEO_GRB            + NEO_KHZ800),
-      _saver(_matrix),
+      _matrix(SIGNAL_PIN),
       _enabled(true)
     {
       pinMode(ENABLE_LED_PIN, OUTPUT);
@@ -53,14 +44,10 @@ class PictureFrame {
       disable();
     }
 
-    Adafruit_NeoMatrix& matrix() {
+    FrameMatrix& matrix() {
       return _matrix;
     }
 
-    void screenSaverUpdate() {
-      _saver.update();
-    }
-
     void disable() {
       if (!_enabled) return;
 
@@ -89,8 +76,7 @@ class PictureFrame {
     }
 
   private:
-    Adafruit_NeoMatrix _matrix;
-    Screensaver _saver;
+    FrameMatrix _matrix;
     bool _enabled;
 };
 
@@ -0,0 +1,146 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _PROGRESS_HPP_
+#define _PROGRESS_HPP_
+
+#include <EEPROM.h>
+
+#include "Telemetry.hpp"
+
+// Where the progress log lives in EEPROM and how many records it holds
+#define PROGRESS_ADDRESS 0
+#define PROGRESS_SLOTS 32
+
+// Most records written between resets, which bounds EEPROM wear however
+// long the sketch runs. Progress past it is kept in RAM only, and every
+// save refused is reported in a Record_Progress.
+#define PROGRESS_MAX_WRITES 64
+
+// Saves the player's progress in EEPROM so it survives sleep and power
+// loss. Each save goes into the slot after the last one, spreading the
+// writes across PROGRESS_SLOTS slots; the valid record with the newest
+// sequence number is the current one.
+class Progress {
+  public:
+    Progress() : _slot(PROGRESS_SLOTS - 1), _writes(0) {
+      _current.sequence = 0;
+      _current.level = 1;
+      _current.trapCount = 0;
+      _current.unlocked = 1 << 1;
+    }
+
+    // Finds the current record. Returns false if there isn't one, leaving
+    // progress at the start of the game.
+    bool load() {
+      bool found = false;
+
+      for (byte slot = 0; slot < PROGRESS_SLOTS; ++slot) {
+        Record r = read(slot);
+        if (r.checksum != checksum(r)) continue;
+
+        // Sequence numbers wrap, but the slots only ever hold a window of
+        // PROGRESS_SLOTS of them, so a signed difference orders them.
+        if (!found || int8_t(r.sequence - _current.sequence) > 0) {
+          _current = r;
+          _slot = slot;
+          found = true;
+        }
+      }
+
+      return found;
+    }
+
+    // Records progress if it has changed, reporting it over telemetry.
+    // Returns true if a record was written.
+    bool save(byte level, byte trapCount) {
+      if (level == _current.level && trapCount == _current.trapCount) return false;
+
+      _current.level = level;
+      _current.trapCount = trapCount;
+      if (level < 16) {
+        _current.unlocked |= 1 << level;
+      }
+
+      if (_writes >= PROGRESS_MAX_WRITES) {
+        telemetry.progress(level, trapCount, _writes, false);
+        return false;
+      }
+
+      _current.sequence++;
+      _current.checksum = checksum(_current);
+
+      _slot = (_slot + 1) % PROGRESS_SLOTS;
+      int address = PROGRESS_ADDRESS + _slot * sizeof(Record);
+      const byte* bytes = (const byte*)&_current;
+      for (byte i = 0; i < sizeof(Record); ++i) {
+        EEPROM.update(address + i, bytes[i]);
+      }
+
+      ++_writes;
+      telemetry.progress(level, trapCount, _writes, true);
+      return true;
+    }
+
+    byte level() {
+      return _current.level;
+    }
+
+    byte trapCount() {
+      return _current.trapCount;
+    }
+
+    // Whether the level at index has been reached. Only the first 16 are
+    // tracked, so later ones never are.
+    bool unlocked(byte level) {
+      return level < 16 && (_current.unlocked & (1 << level));
+    }
+
+  protected:
+    struct Record {
+      byte sequence;
+      byte level;
+      byte trapCount;
+      uint16_t unlocked; // Bit per stored level reached
+      byte checksum;
+    };
+
+    Record read(byte slot) {
+      Record r;
+      int address = PROGRESS_ADDRESS + slot * sizeof(Record);
+      byte* bytes = (byte*)&r;
+      for (byte i = 0; i < sizeof(Record); ++i) {
+        bytes[i] = EEPROM.read(address + i);
+      }
+      return r;
+    }
+
+    // Inverted so erased EEPROM (all 0xFF) never looks like a record
+    static byte checksum(const Record& r) {
+      return ~(r.sequence + r.level + r.trapCount + (r.unlocked & 0xFF) + (r.unlocked >> 8));
+    }
+
+    Record _current;
+    byte _slot; // Slot holding the current record
+    byte _writes;
+};
+
+Progress progress;
+
+#endif
@@ -0,0 +1,43 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#ifndef _RANDOM_HPP_
+#define _RANDOM_HPP_
+
+// A 16 bit xorshift generator. It's small and repeatable, so a seed
+// always gives the same sequence on the board and on a host. The shifts
+// permute the nonzero states, so a nonzero seed never reaches zero; a
+// zero seed is replaced with one.
+class Random {
+  public:
+    void seed(uint16_t seed) {
+      _state = seed ? seed : 1;
+    }
+
+    uint16_t next() {
+      _state ^= _state << 7;
+      _state ^= _state >> 9;
+      _state ^= _state << 8;
+      return _state;
+    }
+
+  private:
+    uint16_t _state = 1;
+};
+
+#endif
@@ -0,0 +1,45 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#ifndef _STEADYINPUT_HPP_
+#define _STEADYINPUT_HPP_
+
+#include "InputProvider.hpp"
+
+// A tilt that never changes, for measuring and testing the physics without
+// the accelerometer's slow reads.
+class SteadyInput : public InputProvider {
+  public:
+    SteadyInput(float x, float y) : _x(x), _y(y) { }
+
+    void update() { }
+
+    float x() {
+      return _x;
+    }
+
+    float y() {
+      return _y;
+    }
+
+  private:
+    float _x;
+    float _y;
+};
+
+#endif
@@ -0,0 +1,222 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _TELEMETRY_HPP_
+#define _TELEMETRY_HPP_
+
+#define TELEMETRY_BAUD 115200
+#define TELEMETRY_VERSION 1
+
+// Every record is framed as
+//   SYNC, version, type, payload length, payload..., checksum
+// where the checksum is the low byte of the sum of everything after SYNC.
+// Multi-byte payload fields are little-endian. tools/telemetry.py decodes
+// the stream.
+#define TELEMETRY_SYNC 0xA5
+
+// Longest payload a record can have
+#define TELEMETRY_MAX_PAYLOAD 28
+
+const byte Record_Ball = 1;    // index, x, y (int16 cells * 256), v_x, v_y (int16 cells per step * 256)
+const byte Record_Level = 2;   // level index, ball count
+const byte Record_Timing = 3;  // update duration (uint16 micros), steps run, frame draw (uint16 mA), records dropped (uint16)
+const byte Record_Sensors = 4; // x, y tilt (int16 milliradians)
+const byte Record_Benchmark = 5; // benchmark id, argument, CPU cycles (uint32)
+const byte Record_Memory = 6;  // bytes free between heap and stack, bytes the stack never reached (uint16)
+const byte Record_Gesture = 7; // gesture recognized (1 shake, 2 double tap, 3 still)
+const byte Record_Clock = 8;   // last show() duration (uint16 micros), millis() behind the Timer1 clock (int32)
+const byte Record_Invariant = 9; // Invariant_ flags broken, ball index (0xFF for none), level index, x, y (int16 cells * 256)
+const byte Record_Transition = 11; // level index, 1 if loaded during the exit animation, micros until its first frame was shown (uint16)
+const byte Record_Pixels = 12; // first pixel in strip order, then the pixels' bytes as sent to the LEDs (G, R, B each)
+const byte Record_Frame = 13;  // frame number (uint16), brightness, 1 if every pixel was resent. Follows a mirrored frame's pixels
+const byte Record_Progress = 14; // level index, trap count, records written since reset, 1 if written or 0 if
+                                 // refused by PROGRESS_MAX_WRITES
+
+// Sends binary records over the serial port without ever waiting for it.
+// Records go into the serial driver's transmit ring buffer, which drains
+// in the background; a record that doesn't fit is dropped and counted.
+class Telemetry {
+  public:
+    void begin() {
+      Serial.begin(TELEMETRY_BAUD);
+    }
+
+    void ball(byte index, float x, float y, float v_x, float v_y) {
+      Record r(Record_Ball);
+      r.add(index);
+      r.add16(x * 256);
+      r.add16(y * 256);
+      r.add16(v_x * 256);
+      r.add16(v_y * 256);
+      send(r);
+    }
+
+    void level(byte index, byte balls) {
+      Record r(Record_Level);
+      r.add(index);
+      r.add(balls);
+      send(r);
+    }
+
+    void timing(uint16_t updateMicros, byte steps, uint16_t frameMilliamps) {
+      Record r(Record_Timing);
+      r.add16(updateMicros);
+      r.add(steps);
+      r.add16(frameMilliamps);
+      r.add16(_dropped);
+      send(r);
+    }
+
+    void sensors(float x, float y) {
+      Record r(Record_Sensors);
+      r.add16(x * 1000);
+      r.add16(y * 1000);
+      send(r);
+    }
+
+    void memory(uint16_t free, uint16_t unused) {
+      Record r(Record_Memory);
+      r.add16(free);
+      r.add16(unused);
+      send(r);
+    }
+
+    void clock(uint16_t showMicros, int32_t millisDrift) {
+      Record r(Record_Clock);
+      r.add16(showMicros);
+      r.add16(millisDrift & 0xFFFF);
+      r.add16(millisDrift >> 16);
+      send(r);
+    }
+
+    void gesture(byte kind) {
+      Record r(Record_Gesture);
+      r.add(kind);
+      send(r);
+    }
+
+    void benchmark(byte id, byte argument, uint32_t cycles) {
+      Record r(Record_Benchmark);
+      r.add(id);
+      r.add(argument);
+      r.add16(cycles & 0xFFFF);
+      r.add16(cycles >> 16);
+      send(r);
+    }
+
+    void invariant(byte violations, byte ball, byte level, float x, float y) {
+      Record r(Record_Invariant);
+      r.add(violations);
+      r.add(ball);
+      r.add(level);
+      r.add16(x * 256);
+      r.add16(y * 256);
+      send(r);
+    }
+
+    void transition(byte level, bool prefetched, uint32_t micros) {
+      Record r(Record_Transition);
+      r.add(level);
+      r.add(prefetched);
+      r.add16(min(micros, 0xFFFFUL));
+      send(r);
+    }
+
+    void progress(byte level, byte trapCount, byte writes, bool written) {
+      Record r(Record_Progress);
+      r.add(level);
+      r.add(trapCount);
+      r.add(writes);
+      r.add(written);
+      send(r);
+    }
+
+    bool pixels(byte start, const uint8_t* channels, byte count) {
+      Record r(Record_Pixels);
+      r.add(start);
+      for (byte i = 0; i < count * 3; ++i) {
+        r.add(channels[i]);
+      }
+      return send(r);
+    }
+
+    bool frame(uint16_t number, byte brightness, bool keyframe) {
+      Record r(Record_Frame);
+      r.add16(number);
+      r.add(brightness);
+      r.add(keyframe);
+      return send(r);
+    }
+
+    // Longest payload a record can have right now without being dropped
+    byte room() {
+      int available = Serial.availableForWrite() - RECORD_OVERHEAD;
+      return constrain(available, 0, TELEMETRY_MAX_PAYLOAD);
+    }
+
+    uint16_t dropped() {
+      return _dropped;
+    }
+
+  protected:
+    // SYNC, version, type and length, then the checksum
+    static const byte RECORD_OVERHEAD = 5;
+
+    struct Record {
+      Record(byte type_) : type(type_), length(0) { }
+
+      void add(byte value) {
+        payload[length++] = value;
+      }
+
+      void add16(int16_t value) {
+        add(value & 0xFF);
+        add(value >> 8);
+      }
+
+      byte type;
+      byte length;
+      byte payload[TELEMETRY_MAX_PAYLOAD];
+    };
+
+    bool send(const Record& r) {
+      if (Serial.availableForWrite() < r.length + RECORD_OVERHEAD) {
+        ++_dropped;
+        return false;
+      }
+
+      byte checksum = TELEMETRY_VERSION + r.type + r.length;
+      Serial.write(TELEMETRY_SYNC);
+      Serial.write(TELEMETRY_VERSION);
+      Serial.write(r.type);
+      Serial.write(r.length);
+      for (byte i = 0; i < r.length; ++i) {
+        Serial.write(r.payload[i]);
+        checksum += r.payload[i];
+      }
+      Serial.write(checksum);
+      return true;
+    }
+
+    uint16_t _dropped = 0;
+};
+
+Telemetry telemetry;
+
+#endif
@@ -0,0 +1,159 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _TILTESTIMATOR_HPP_
+#define _TILTESTIMATOR_HPP_
+
+#include "Accelerometer.hpp"
+#include "GestureDetector.hpp"
+#include "InputProvider.hpp"
+
+// atan(k / 16) for k = 0..16, in binary angle units (65536 per turn)
+const uint16_t atanTable[] PROGMEM = {
+  0, 651, 1297, 1933, 2555, 3159, 3742, 4302, 4836,
+  5344, 5826, 6282, 6712, 7117, 7498, 7856, 8192
+};
+
+// 1 / sqrt(1 + k / 8) for k = 0..24, scaled by 32768
+const uint16_t rsqrtTable[] PROGMEM = {
+  32768, 30894, 29309, 27945, 26755, 25705, 24770, 23930, 23170,
+  22479, 21845, 21263, 20724, 20225, 19760, 19326, 18919, 18536,
+  18176, 17837, 17515, 17211, 16921, 16646, 16384
+};
+
+// Samples averaged to find the zero point
+#define TILT_CALIBRATION_SAMPLES 8
+
+// Estimates how far the board is tilted from the gravity vector measured
+// on all three axes. Pitch and roll are each axis's angle above the plane
+// of the other two, so they stay linear in the tilt and don't depend on
+// which way up the board is. They're measured from a zero point taken by
+// calibrate(), so the board plays level however it's being held then.
+//
+// All the math is in integers with table lookups: an update costs three
+// 32-bit squares, two square roots and two divisions on top of reading
+// the axes.
+class TiltEstimator : public InputProvider {
+  public:
+    TiltEstimator(Accelerometer& accel)
+      : _accel(accel), _pitch(0), _roll(0), _pitchZero(0), _rollZero(0)
+    { }
+
+    // Takes the board's current attitude as level
+    void calibrate() {
+      long pitchSum = 0;
+      long rollSum = 0;
+      for (byte i = 0; i < TILT_CALIBRATION_SAMPLES; ++i) {
+        measure();
+        pitchSum += _pitch;
+        rollSum += _roll;
+      }
+      _pitchZero = pitchSum / TILT_CALIBRATION_SAMPLES;
+      _rollZero = rollSum / TILT_CALIBRATION_SAMPLES;
+    }
+
+    void update() override {
+      measure();
+    }
+
+    // Tilt along the X and Y axes from the zero point, in radians
+    float x() override {
+      return toRadians(_pitch - _pitchZero);
+    }
+    float y() override {
+      return toRadians(_roll - _rollZero);
+    }
+
+    // Angle of the vector (x, y) in binary angle units, 65536 per turn
+    static int16_t intAtan2(long y, long x) {
+      if (x == 0 && y == 0) return 0;
+
+      // Find the angle within the first octant from the smaller side over
+      // the larger, then reflect it out to the right one
+      unsigned long ax = abs(x);
+      unsigned long ay = abs(y);
+      bool steep = ay > ax;
+      uint16_t ratio = ((steep ? ax : ay) << 10) / (steep ? ay : ax); // 1024 is 1
+
+      uint16_t angle;
+      if (ratio >= 1024) {
+        angle = 8192;
+      } else {
+        byte i = ratio >> 6;
+        uint16_t a0 = pgm_read_word_near(atanTable + i);
+        uint16_t a1 = pgm_read_word_near(atanTable + i + 1);
+        angle = a0 + (uint16_t)(((uint32_t)(a1 - a0) * (ratio & 63)) >> 6);
+      }
+
+      if (steep) angle = 16384 - angle;
+      if (x < 0) angle = 32768 - angle;
+      return y < 0 ? -(int16_t)angle : (int16_t)angle;
+    }
+
+    // Square root from the reciprocal square root table. s is scaled by a
+    // power of 4 into [4096, 16384), where the table applies.
+    static uint16_t intSqrt(unsigned long s) {
+      if (s == 0) return 0;
+
+      int8_t halfShift = 0;
+      while (s >= 16384) {
+        s >>= 2;
+        ++halfShift;
+      }
+      while (s < 4096) {
+        s <<= 2;
+        --halfShift;
+      }
+
+      uint16_t offset = s - 4096;
+      byte i = offset >> 9;
+      uint16_t r0 = pgm_read_word_near(rsqrtTable + i);
+      uint16_t r1 = pgm_read_word_near(rsqrtTable + i + 1);
+      uint16_t r = r0 - (uint16_t)(((uint32_t)(r0 - r1) * (offset & 511)) >> 9);
+
+      // s * rsqrt(s / 4096) / 32768 is 64 * sqrt(s), rounded here
+      byte shift = 21 - halfShift;
+      return ((uint32_t)s * r + (1UL << (shift - 1))) >> shift;
+    }
+
+  protected:
+    void measure() {
+      long x = _accel.readXMilliG();
+      long y = _accel.readYMilliG();
+      long z = _accel.readZMilliG();
+      gestures.sample(x, y, z);
+
+      _pitch = intAtan2(x, intSqrt(y * y + z * z));
+      _roll = intAtan2(y, intSqrt(x * x + z * z));
+    }
+
+    static float toRadians(int16_t angle) {
+      return angle * (2 * PI / 65536.0);
+    }
+
+    Accelerometer& _accel;
+    int16_t _pitch; // Binary angle units
+    int16_t _roll;
+    int16_t _pitchZero;
+    int16_t _rollZero;
+};
+
+TiltEstimator tilt(accelerometer);
+
+#endif
@@ -0,0 +1,95 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Runs attract mode's demos the way attract() does, with uneven time
+// between updates, checking each reaches its exit before it times out,
+// that the exit loads the next demo's level and no other, and that the
+// demos never hand the board back by themselves. Then tilts the board to
+// check it's handed back, and runs the attract benchmark to check it
+// returns and leaves the game as it was.
+
+#include "HostSketch.hpp"
+
+#define ROUNDS 2
+
+// Most millis between updates
+#define JITTER 15
+
+int main() {
+  setup();
+  srand(1);
+
+  controller.setBallCount(1);
+  controller.setInput(autoplayer);
+  autoplayer.start();
+
+  int completed = 0;
+  byte demo = autoplayer._demo;
+  uint32_t demoStartTm = cycleTimer.millis();
+  while (completed < ROUNDS * DEMO_COUNT) {
+    host_millis += 1 + rand() % JITTER;
+    controller.update();
+
+    byte level = pgm_read_byte(&demos[demo].level);
+    byte nextLevel = pgm_read_byte(&demos[(demo + 1) % DEMO_COUNT].level);
+    if (!expect(controller.levelIndex() == level || controller.levelIndex() == nextLevel,
+                "demo of level %d: exit led to level %d, not %d", level, controller.levelIndex(), nextLevel)) break;
+    expect(controller.ballCount() == 1 && controller.balls().count == 1, "demo of level %d: %d balls", level, controller.balls().count);
+    if (!expect(!autoplayer.interrupted(), "demo of level %d: handed back without a tilt", level)) break;
+
+    if (autoplayer.demoOver()) {
+      uint32_t elapsed = cycleTimer.millis() - demoStartTm;
+      if (!expect(controller.levelIndex() == nextLevel, "demo of level %d: timed out after %u ms", level, elapsed)) break;
+
+      autoplayer.nextDemo();
+      expect(controller.levelIndex() == nextLevel, "demo of level %d: next demo loaded level %d", level, controller.levelIndex());
+      demo = autoplayer._demo;
+      demoStartTm = cycleTimer.millis();
+      ++completed;
+    }
+  }
+  expect(controller.trapCount() == 0, "demos hit %d traps on level 1", controller.trapCount());
+  printf("%d demos reached their exits, %d ms apart at most between updates\n", completed, JITTER);
+
+  // Tilting the board takes it back
+  hostTilt(0.2, 0);
+  uint32_t tiltTm = cycleTimer.millis();
+  while (!autoplayer.interrupted() && cycleTimer.millis() - tiltTm < 1000) {
+    host_millis += 1;
+    controller.update();
+  }
+  uint32_t handback = cycleTimer.millis() - tiltTm;
+  expect(handback <= 50, "tilting the board handed it back after %u ms", handback);
+  printf("handed back %u ms after a tilt\n", handback);
+
+  // The exit leads on through the levels again once attract mode stops
+  autoplayer.stop();
+  controller.setInput(tilt);
+  controller.setLevel(3);
+  expect(!controller._exitFixed, "exit still fixed after stop()");
+
+  // The benchmark waits on the clock, which only moves when it's read here
+  hostTilt(0, 0);
+  host_clock_micros = 100;
+  Benchmark(controller, pictureFrame.matrix(), levels, autoplayer).benchmarkAttract();
+  host_clock_micros = 0;
+  expect(controller._input == &tilt && !controller._exitFixed, "the attract benchmark didn't give the game back");
+
+  return finish("AttractTest");
+}
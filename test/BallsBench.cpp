@@ -0,0 +1,69 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Host timing of one physics step with 1, 4 and 16 balls, the same work
+// as Benchmark_Balls. Built with MAX_BALLS raised to 16. Host times only
+// show how the cost grows with the balls; the cycle counts that decide the
+// tick budget come from the Benchmark on the device.
+
+#include "HostSketch.hpp"
+
+#include <time.h>
+
+#define STEPS 200
+#define REPEATS 2000
+
+static double nowNanos() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+int main() {
+  setup();
+
+  const float tilts[4][2] = { { 0.3, 0.1 }, { -0.1, 0.3 }, { -0.3, -0.1 }, { 0.1, -0.3 } };
+  double single = 0;
+
+  for (byte count = 1; count <= 16; count *= 4) {
+    controller.setBallCount(count);
+
+    double total = 0;
+    byte balls = 0;
+    for (int r = 0; r < REPEATS; ++r) {
+      controller.setLevel(1);
+      balls = controller.balls().count;
+
+      double start = nowNanos();
+      for (int i = 0; i < STEPS; ++i) {
+        const float* tilt = tilts[(i / 50) % 4];
+        controller.simulateStep(tilt[0], tilt[1]);
+      }
+      total += nowNanos() - start;
+    }
+
+    double perStep = total / (REPEATS * STEPS);
+    if (count == 1) single = perStep;
+    expect(balls == count, "%d balls asked for, %d in play", count, balls);
+    printf("%2d balls: %6.1f ns a step, %.2fx one ball, %.2fx per ball\n",
+           balls, perStep, perStep / single, perStep / single / balls);
+  }
+
+  return finish("BallsBench");
+}
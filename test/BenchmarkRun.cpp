@@ -0,0 +1,48 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Runs the sketch's own Benchmark, as a BENCHMARK build does at startup,
+// with Timer1 counting host cycles. The telemetry records it sends go to
+// the file named on the command line, for tools/telemetry.py to decode,
+// so results line up with a device's by benchmark id and argument.
+// They're host cycles: they compare commits with each other, not with the
+// AVR. Time the device spends waiting counts as it would there, though,
+// including each analog read's conversion.
+
+#include "HostSketch.hpp"
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: %s FILE\n", argv[0]);
+    return 2;
+  }
+
+  host_serial_file = fopen(argv[1], "wb");
+  if (!expect(host_serial_file, "can't write %s", argv[1])) return finish("BenchmarkRun");
+
+  host_cycle_clock = true;
+  // 13 ADC clocks at 125 kHz, the 16 MHz clock divided by analogRead()'s
+  // prescaler of 128
+  host_adc_micros = 104;
+  setup();
+  Benchmark(controller, pictureFrame.matrix(), levels, autoplayer).run();
+
+  fclose(host_serial_file);
+  return finish("BenchmarkRun");
+}
@@ -0,0 +1,61 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Host cycles, read from the x86 time stamp counter, for one update()
+// running a physics step and for one redrawBoard(), on every level. Each
+// is the best of many runs, which keeps out interrupts and cache misses.
+// Host cycles only compare builds of the sketch with each other; the
+// Benchmark on the device gives the AVR's.
+
+#include <x86intrin.h>
+
+#include "HostSketch.hpp"
+
+#define RUNS 3000
+
+int main() {
+  setup();
+
+  unsigned long long totalUpdate = 0, totalRedraw = 0;
+  for (byte level = 0; level < levels.count; ++level) {
+    unsigned long long bestUpdate = ~0ull, bestRedraw = ~0ull;
+    for (int run = 0; run < RUNS; ++run) {
+      controller.setLevel(level);
+
+      unsigned long long start = __rdtsc();
+      controller.redrawBoard();
+      unsigned long long elapsed = __rdtsc() - start;
+      bestRedraw = min(bestRedraw, elapsed);
+
+      // Let one physics step come due
+      host_millis += 10;
+      start = __rdtsc();
+      controller.update();
+      elapsed = __rdtsc() - start;
+      bestUpdate = min(bestUpdate, elapsed);
+    }
+
+    printf("level %2d: update %6llu, redrawBoard %6llu\n", level, bestUpdate, bestRedraw);
+    totalUpdate += bestUpdate;
+    totalRedraw += bestRedraw;
+  }
+
+  printf("all levels: update %llu, redrawBoard %llu host cycles\n", totalUpdate, totalRedraw);
+  return finish("BoardBench");
+}
@@ -0,0 +1,69 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// The cell logic the trait table replaced, kept for CellTraitsTest to check
+// the table against and CellTraitsBench to time it against:
+// ColorPalette::colorForCell(), BoardController::solidCell() and step()'s
+// chain over cell ranges.
+
+#ifndef _CELLSWITCH_HPP_
+#define _CELLSWITCH_HPP_
+
+#include "HostSketch.hpp"
+
+static uint16_t oldColor(byte cell) {
+  typedef ColorPalette P;
+
+  if (cell >= Cell_PointerBase) return P::orange;
+
+  if (cell > Cell_WarpBase) return P::green;
+
+  switch (cell) {
+    case Cell_WarpBase   : return P::purple;
+    case Cell_Wall       : return P::white;
+    case Cell_Wall_Purple: return P::purple;
+    case Cell_Trap       : return P::red;
+    case Cell_Wall_Cyan  : return P::cyan;
+    case Cell_Exit       : return P::green;
+    default              : return P::off;
+  }
+}
+
+static bool oldSolid(byte cell) {
+  if (cell >= Cell_WarpBase) return false;
+
+  switch (cell) {
+    case Cell_Empty:
+    case Cell_Trap:
+    case Cell_Exit:
+      return false;
+    default:
+      return true;
+  }
+}
+
+static byte oldEvent(byte cell) {
+  if (cell >= Cell_PointerBase) return Event_Teleport;
+  if (cell >= Cell_WarpBase) return Event_Warp;
+  if (cell == Cell_Exit) return Event_Exit;
+  if (cell == Cell_Trap) return Event_Trap;
+  return Event_None;
+}
+
+#endif
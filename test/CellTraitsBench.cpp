@@ -0,0 +1,87 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Host cycles, read from the x86 time stamp counter, for one cell trait
+// lookup through the trait table and through the switches it replaced,
+// kept in CellSwitch.hpp. Averaged over every cell value, as
+// Benchmark_CellTraits does, and over the cells of every level, which are
+// mostly walls and empty. Each is the best of many runs. Host cycles only
+// compare the two with each other; the Benchmark on the device gives the
+// AVR's.
+
+#include <x86intrin.h>
+
+#include "CellSwitch.hpp"
+
+#define RUNS 3000
+
+static volatile uint16_t sink;
+
+// Hides the cell from the compiler, so lookups of known cells aren't
+// folded into constants
+static byte opaque(byte cell) {
+  asm volatile("" : "+r"(cell));
+  return cell;
+}
+
+// Best of RUNS over the cells, in host cycles per lookup
+template <typename Lookup>
+static double best(const byte* cells, int count, Lookup lookup) {
+  unsigned long long bestElapsed = ~0ull;
+  for (int run = 0; run < RUNS; ++run) {
+    unsigned long long start = __rdtsc();
+    for (int i = 0; i < count; ++i) {
+      sink = lookup(opaque(cells[i]));
+    }
+    bestElapsed = min(bestElapsed, __rdtsc() - start);
+  }
+  return double(bestElapsed) / count;
+}
+
+static void compare(const char* name, const byte* cells, int count) {
+  printf("%s: solid %.1f / %.1f, event %.1f / %.1f, color %.1f / %.1f host cycles, table / switch\n", name,
+         best(cells, count, [](byte c) { return uint16_t(Cell::solid(c)); }),
+         best(cells, count, [](byte c) { return uint16_t(oldSolid(c)); }),
+         best(cells, count, [](byte c) { return uint16_t(Cell::event(c)); }),
+         best(cells, count, [](byte c) { return uint16_t(oldEvent(c)); }),
+         best(cells, count, [](byte c) { return Cell::color(c); }),
+         best(cells, count, [](byte c) { return oldColor(c); }));
+}
+
+int main() {
+  static byte values[256];
+  for (int cell = 0; cell < 256; ++cell) {
+    values[cell] = cell;
+  }
+  compare("every cell value", values, 256);
+
+  static byte board[256 * MATRIX_WIDTH * MATRIX_HEIGHT];
+  int count = 0;
+  for (byte level = 0; level < levels.count; ++level) {
+    Level<> l = levels.level(level);
+    for (byte y = 0; y < MATRIX_HEIGHT; ++y) {
+      for (byte x = 0; x < MATRIX_WIDTH; ++x) {
+        board[count++] = l.cellAt(x, y);
+      }
+    }
+  }
+  compare("cells of every level", board, count);
+
+  return finish("CellTraitsBench");
+}
@@ -0,0 +1,39 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Checks the cell trait table against the logic it replaced, kept in
+// CellSwitch.hpp: the color, solidity and event of all 256 cell values
+// match what colorForCell(), solidCell() and step()'s chain over cell
+// ranges gave.
+
+#include "CellSwitch.hpp"
+
+int main() {
+  for (int cell = 0; cell < 256; ++cell) {
+    expect(Cell::color(cell) == oldColor(cell), "cell %d: color %04x, was %04x", cell, Cell::color(cell), oldColor(cell));
+    expect(Cell::solid(cell) == oldSolid(cell), "cell %d: solid %d, was %d", cell, Cell::solid(cell), oldSolid(cell));
+    expect(Cell::event(cell) == oldEvent(cell), "cell %d: event %d, was %d", cell, Cell::event(cell), oldEvent(cell));
+
+    // A cell either blocks the ball or can be entered, never both
+    expect(!(Cell::solid(cell) && Cell::event(cell) != Event_None), "cell %d: solid with an event", cell);
+  }
+
+  printf("256 cell values, %d cell types\n", CellType_Pointer + 1);
+  return finish("CellTraitsTest");
+}
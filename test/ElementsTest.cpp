@@ -0,0 +1,155 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Checks the level elements. Doors and movers patch only the cells they
+// cover in the collision map, so after every update() of a long random
+// game the map must match one rebuilt from scratch. A switch pressed while
+// a ball holds its door open must still close the door once the ball has
+// gone.
+
+#include "HostSketch.hpp"
+
+#define SEEDS 40
+#define CALLS 3000
+
+// A random tilt, changed every few calls
+class RandomInput : public InputProvider {
+  public:
+    RandomInput(uint16_t seed) : _calls(0) {
+      _random.seed(seed);
+    }
+
+    void update() {
+      if (_calls++ % 40 == 0) {
+        _x = (int(_random.next() % 81) - 40) / 100.0;
+        _y = (int(_random.next() % 81) - 40) / 100.0;
+      }
+    }
+
+    float x() { return _x; }
+    float y() { return _y; }
+
+  private:
+    Random _random;
+    int _calls;
+    float _x;
+    float _y;
+};
+
+// Cells of the collision map that differ from a full rebuild
+static int mismatches() {
+  int count = 0;
+  for (int x = 0; x < MATRIX_WIDTH; ++x) {
+    for (int y = 0; y < MATRIX_HEIGHT; ++y) {
+      bool solid = Cell::solid(controller.level()->cellAt(x, y)) || controller.elementCovers(x, y);
+      count += solid != controller._solid.contains(x, y);
+    }
+  }
+  return count;
+}
+
+static void moveBall(byte i, int x, int y) {
+  controller._occupied.remove(controller._balls.xInt(i), controller._balls.yInt(i));
+  controller._balls.x[i] = x + 0.5;
+  controller._balls.y[i] = y + 0.5;
+  controller._balls.savePosition(i);
+  controller._occupied.add(x, y);
+}
+
+static void collisionMap() {
+  long changes = 0;
+  for (uint16_t seed = 1; seed <= SEEDS; ++seed) {
+    RandomInput input(seed);
+    controller.setInput(input);
+    controller.setBallCount(seed % 2 ? 1 : MAX_BALLS);
+    controller.setTrapCount(0);
+    controller.setLevel(2);
+    controller.restartClock();
+
+    for (int call = 0; call < CALLS; ++call) {
+      host_millis += 1 + seed % 7;
+      changes += controller.update();
+      if (controller.levelIndex() != 2) {
+        controller.setTrapCount(0);
+        controller.setLevel(2);
+      }
+
+      int wrong = mismatches();
+      if (!expect(wrong == 0, "seed %u call %d: %d cells of the collision map differ from a rebuild",
+                  seed, call, wrong)) break;
+    }
+  }
+
+  controller.setInput(tilt);
+  controller.setBallCount(BALL_COUNT);
+  expect(changes > 1000, "only %ld changes to the board", changes);
+  printf("%d games, %ld changes to the board, collision map always matched\n", SEEDS, changes);
+}
+
+static void heldSwitch() {
+  const byte door = 2; // Only opened by the switch
+  const byte doorX = 15, doorY = 12;
+  BoardController<>::ElementState& state = controller._elementStates[door];
+
+  controller.setBallCount(1);
+  controller.setLevel(2);
+
+  // Open the door, then roll into it and press the switch again
+  expect(controller.toggleDoor(door) && !state.active, "the switch didn't open the door");
+  moveBall(0, doorX, doorY);
+  expect(!controller.toggleDoor(door) && !state.active, "the door closed on a ball");
+
+  // It stays open while the ball is there, and closes once it leaves
+  for (int i = 0; i < 5; ++i) controller.tickElements();
+  expect(!state.active, "the door closed on a ball");
+  moveBall(0, doorX, doorY - 1);
+  controller.tickElements();
+  expect(state.active && controller._solid.contains(doorX, doorY), "the held back press was lost");
+  expect(mismatches() == 0, "the collision map differs from a rebuild");
+
+  // Pressing again while it waits cancels the press
+  expect(controller.toggleDoor(door) && !state.active, "the switch didn't open the door");
+  moveBall(0, doorX, doorY);
+  controller.toggleDoor(door);
+  controller.toggleDoor(door);
+  moveBall(0, doorX, doorY - 1);
+  for (int i = 0; i < 5; ++i) controller.tickElements();
+  expect(!state.active, "two presses didn't cancel");
+
+  // A timed door held open by a ball closes as soon as the ball leaves
+  const byte timed = 1;
+  BoardController<>::ElementState& timedState = controller._elementStates[timed];
+  while (timedState.active) controller.tickElements();
+  moveBall(0, 16, 11);
+  for (int i = 0; i < 40; ++i) controller.tickElements();
+  expect(!timedState.active, "the timed door closed on a ball");
+  moveBall(0, 16, 10);
+  controller.tickElements();
+  expect(timedState.active, "the timed door didn't close after the ball left");
+  expect(timedState.countdown == controller.level()->element(timed).period, "the timed door lost its period");
+
+  controller.setBallCount(BALL_COUNT);
+}
+
+int main() {
+  setup();
+  collisionMap();
+  heldSwitch();
+  return finish("ElementsTest");
+}
@@ -0,0 +1,106 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Host cycles, read from the x86 time stamp counter, for drawing every
+// pixel of a frame and for changing the brightness, through FrameMatrix and
+// through the NeoMatrix library's path it replaced, where the library
+// expands each color and scales it by its own brightness. Each is the best
+// of many runs. The library here is the stand-in in stubs/, which follows
+// the library's code but expands colors by division where the library
+// reads gamma tables. Host cycles only compare the two paths with each
+// other; the Benchmark on the device gives the AVR's.
+
+#include <x86intrin.h>
+
+#include "HostSketch.hpp"
+
+#define RUNS 3000
+
+static uint16_t testColor(int16_t x, int16_t y) {
+  uint16_t i = y * MATRIX_WIDTH + x;
+  return ((i & 0x1F) << 11) | (((i * 7) & 0x3F) << 5) | ((i * 3 + 5) & 0x1F);
+}
+
+int main() {
+  FrameMatrix tables(6);
+  tables.setBrightness(BRIGHTNESS);
+
+  FrameMatrix library(6);
+  library.Adafruit_NeoMatrix::setBrightness(BRIGHTNESS);
+
+  unsigned long long bestTables = ~0ull, bestLibrary = ~0ull;
+  unsigned long long bestScale = ~0ull, bestLibraryScale = ~0ull;
+  for (int run = 0; run < RUNS; ++run) {
+    unsigned long long start = __rdtsc();
+    for (int16_t y = 0; y < MATRIX_HEIGHT; ++y) {
+      for (int16_t x = 0; x < MATRIX_WIDTH; ++x) {
+        tables.drawPixel(x, y, testColor(x, y));
+      }
+    }
+    unsigned long long elapsed = __rdtsc() - start;
+    bestTables = min(bestTables, elapsed);
+
+    start = __rdtsc();
+    for (int16_t y = 0; y < MATRIX_HEIGHT; ++y) {
+      for (int16_t x = 0; x < MATRIX_WIDTH; ++x) {
+        library.Adafruit_NeoMatrix::drawPixel(x, y, testColor(x, y));
+      }
+    }
+    elapsed = __rdtsc() - start;
+    bestLibrary = min(bestLibrary, elapsed);
+
+    // The power limit dims the frame, and brings it back later
+    uint8_t dimmed = BRIGHTNESS * 3 / 4;
+    start = __rdtsc();
+    tables.scaleBrightness(dimmed);
+    elapsed = __rdtsc() - start;
+    bestScale = min(bestScale, elapsed);
+    tables.scaleBrightness(BRIGHTNESS);
+
+    start = __rdtsc();
+    library.Adafruit_NeoMatrix::setBrightness(dimmed);
+    library.sumChannels();
+    elapsed = __rdtsc() - start;
+    bestLibraryScale = min(bestLibraryScale, elapsed);
+    library.Adafruit_NeoMatrix::setBrightness(BRIGHTNESS);
+  }
+
+  printf("full frame of a different color each pixel: FrameMatrix %llu, library %llu host cycles\n", bestTables, bestLibrary);
+  printf("dimming it: FrameMatrix %llu, library %llu host cycles\n", bestScale, bestLibraryScale);
+
+  // Most frames are a board, runs of a few colors
+  setup();
+  FrameMatrix& board = pictureFrame.matrix();
+  unsigned long long worstScale = 0;
+  for (byte level = 0; level < levels.count; ++level) {
+    controller.setLevel(level);
+    controller.redrawBoard();
+    bestScale = ~0ull;
+    for (int run = 0; run < RUNS; ++run) {
+      unsigned long long start = __rdtsc();
+      board.scaleBrightness(BRIGHTNESS * 3 / 4);
+      unsigned long long elapsed = __rdtsc() - start;
+      bestScale = min(bestScale, elapsed);
+      board.scaleBrightness(BRIGHTNESS);
+    }
+    worstScale = max(worstScale, bestScale);
+  }
+  printf("dimming a board, worst level: FrameMatrix %llu host cycles\n", worstScale);
+  return finish("FrameBench");
+}
@@ -0,0 +1,107 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Checks that changing the brightness back and forth, as the power limit
+// does, leaves the framebuffer as a fresh draw at the final brightness
+// would, rather than losing a little more precision each time.
+
+#include "HostSketch.hpp"
+
+#define ROUND_TRIPS 100
+
+// Every level of each channel somewhere on the board
+static uint16_t testColor(int16_t x, int16_t y) {
+  uint16_t i = y * MATRIX_WIDTH + x;
+  return ((i & 0x1F) << 11) | (((i * 7) & 0x3F) << 5) | ((i * 3 + 5) & 0x1F);
+}
+
+static void draw(FrameMatrix& m) {
+  for (int16_t y = 0; y < MATRIX_HEIGHT; ++y) {
+    for (int16_t x = 0; x < MATRIX_WIDTH; ++x) {
+      m.drawPixel(x, y, testColor(x, y));
+    }
+  }
+}
+
+// The largest difference between any two channels of the framebuffers
+static int maxError(FrameMatrix& a, FrameMatrix& b) {
+  int error = 0;
+  for (uint16_t i = 0; i < a.numPixels() * 3; ++i) {
+    error = max(error, abs(int(a.getPixels()[i]) - int(b.getPixels()[i])));
+  }
+  return error;
+}
+
+int main() {
+  static const uint8_t dims[] = { 200, 127, 64, 30 };
+
+  for (byte d = 0; d < sizeof(dims); ++d) {
+    FrameMatrix fresh(6);
+    fresh.setBrightness(255);
+    draw(fresh);
+
+    FrameMatrix tripped(6);
+    tripped.setBrightness(255);
+    draw(tripped);
+
+    // The same round trips through the old approach, multiplying the
+    // bytes by the ratio of the brightnesses, for comparison
+    FrameMatrix multiplied(6);
+    multiplied.setBrightness(255);
+    draw(multiplied);
+
+    // The first trip loses what the fresh draw's dithering added; after
+    // the second, nothing more changes
+    int settledError = 0;
+    for (int trip = 0; trip < ROUND_TRIPS; ++trip) {
+      tripped.scaleBrightness(dims[d]);
+      tripped.scaleBrightness(255);
+      if (trip == 1) settledError = maxError(tripped, fresh);
+
+      uint8_t* pixels = multiplied.getPixels();
+      for (uint16_t i = 0; i < multiplied.numPixels() * 3; ++i) {
+        pixels[i] = pixels[i] * (dims[d] + 1) >> 8;
+        pixels[i] = min(255UL, pixels[i] * ((256UL << 8) / (dims[d] + 1)) >> 8);
+      }
+    }
+
+    int error = maxError(tripped, fresh);
+    printf("brightness 255 -> %3d -> 255: off by %d after %d round trips, %d multiplying the bytes\n",
+           dims[d], error, ROUND_TRIPS, maxError(multiplied, fresh));
+    expect(error == settledError, "brightness %d: error grew from %d to %d over %d round trips", dims[d], settledError, error, ROUND_TRIPS);
+
+    // Off by no more than the fresh draw's dithering and a step at the
+    // lower brightness, which stands for this many at full
+    expect(error <= 2 + 255 / (dims[d] + 1), "brightness %d: round trips off by %d", dims[d], error);
+
+    // The power estimate follows the bytes
+    uint32_t sum = 0;
+    for (uint16_t i = 0; i < tripped.numPixels() * 3; ++i) sum += tripped.getPixels()[i];
+    expect(sum == tripped._channelSum, "brightness %d: channel sum %lu, bytes add to %lu", dims[d], (unsigned long)tripped._channelSum, (unsigned long)sum);
+
+    // Going down once matches a fresh draw at that brightness
+    FrameMatrix dim(6);
+    dim.setBrightness(dims[d]);
+    draw(dim);
+    fresh.scaleBrightness(dims[d]);
+    expect(maxError(fresh, dim) <= 1, "brightness %d: scaling down off by %d from a fresh draw", dims[d], maxError(fresh, dim));
+  }
+
+  return finish("FrameMatrixTest");
+}
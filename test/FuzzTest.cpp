@@ -0,0 +1,66 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Runs the Fuzzer's checks on the host, where a tilt sequence takes
+// microseconds instead of the seconds its animations take on the board.
+// Every stored level and the first generated mazes are played with one
+// ball and with MAX_BALLS.
+//
+//   FuzzTest [FIRST LAST [SHARD SHARDS]]
+//
+// tries seeds FIRST to LAST, 1 to 64 by default, keeping those equal to
+// SHARD modulo SHARDS so fuzz.sh can split a range between processes.
+// Each failure is printed shrunk: the segments kept and the steps of the
+// last one needed.
+
+#include "HostSketch.hpp"
+#include "../Fuzzer.hpp"
+
+#define MAZES 4
+
+int main(int argc, char** argv) {
+  uint16_t first = argc > 2 ? atoi(argv[1]) : 1;
+  uint16_t last = argc > 2 ? atoi(argv[2]) : 64;
+  unsigned shard = argc > 4 ? atoi(argv[3]) : 0;
+  unsigned shards = argc > 4 ? atoi(argv[4]) : 1;
+
+  setup();
+  Fuzzer fuzzer(controller);
+  long sequences = 0;
+
+  const byte ballCounts[] = { 1, MAX_BALLS };
+  for (byte b = 0; b < 2; ++b) {
+    controller.setBallCount(ballCounts[b]);
+    for (int level = 0; level < levels.count + MAZES; ++level) {
+      for (uint32_t seed = first; seed <= last; ++seed) {
+        if (seed % shards != shard) continue;
+        ++sequences;
+
+        byte segments, steps;
+        uint16_t step = fuzzer.check(level, seed, segments, steps);
+        expect(step == FUZZ_PASSED,
+               "level %d, %d balls, seed %u: an invariant broke at step %u, segments %02x, the last for %d steps",
+               level, ballCounts[b], seed, step, segments, steps);
+      }
+    }
+  }
+
+  printf("%ld tilt sequences of %d steps\n", sequences, FUZZ_SEGMENTS * FUZZ_SEGMENT_STEPS);
+  return finish("FuzzTest");
+}
@@ -0,0 +1,196 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Leaves a board still from power on, checking it plays attract mode
+// before sleeping. A board that vibrates a little is never still, so it
+// plays attract mode until the sleep timeout.
+//
+// Shakes the board on level 0 and on another level, checking only level
+// 0's shake switches between one ball and multi-ball.
+//
+// Then replays the accelerometer traces in the directory named on the
+// command line, build/traces by default, through the gesture detector.
+// tools/gesture_traces.py writes them when the tests are built. Every
+// gesture a trace expects must be recognized. Any others are false
+// positives, most of them from traces of ordinary play, and their rate
+// over all the traces must stay under MAX_FALSE_PER_HOUR.
+
+#include <dirent.h>
+#include <string>
+
+#include "HostSketch.hpp"
+
+// A spurious double-tap skips the player's level, so one every ten
+// minutes is already annoying
+#define MAX_FALSE_PER_HOUR 6
+
+static const char* gestureNames[] = { "none", "shake", "doubletap", "still" };
+
+// Returns false if the file isn't a trace
+static bool replay(const std::string& path, long& millis, int& falsePositives) {
+  FILE* f = fopen(path.c_str(), "r");
+  if (!f) return false;
+
+  int period = 0;
+  int expected[4] = { 0 };
+  bool header = fscanf(f, "# period %d\n# expect shake %d doubletap %d still %d\n", &period,
+                       &expected[Gesture_Shake], &expected[Gesture_DoubleTap], &expected[Gesture_Still]) == 4;
+  if (!header) {
+    fclose(f);
+    return false;
+  }
+
+  GestureDetector detector;
+  int counts[4] = { 0 };
+  int x, y, z;
+  millis = 0;
+  while (fscanf(f, "%d %d %d", &x, &y, &z) == 3) {
+    host_millis += period;
+    detector.sample(x, y, z);
+    counts[detector.take()]++;
+    millis += period;
+  }
+  fclose(f);
+
+  falsePositives = 0;
+  for (int g = Gesture_Shake; g <= Gesture_Still; ++g) {
+    expect(counts[g] >= expected[g], "%s: %d %s, expected %d", path.c_str(), counts[g], gestureNames[g], expected[g]);
+    if (counts[g] > expected[g]) {
+      printf("%s: %d %s, expected %d\n", path.c_str(), counts[g], gestureNames[g], expected[g]);
+      falsePositives += counts[g] - expected[g];
+    }
+  }
+  return true;
+}
+
+static void traces(const char* directory) {
+  DIR* dir = opendir(directory);
+  if (!expect(dir, "no trace directory %s", directory)) return;
+
+  int files = 0;
+  long millis = 0;
+  int falsePositives = 0;
+  while (dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.size() < 4 || name.compare(name.size() - 4, 4, ".txt") != 0) continue;
+
+    long length = 0;
+    int count = 0;
+    if (expect(replay(std::string(directory) + "/" + name, length, count), "%s isn't a trace", name.c_str())) {
+      ++files;
+      millis += length;
+      falsePositives += count;
+    }
+  }
+  closedir(dir);
+
+  if (!expect(files > 0, "no traces in %s", directory)) return;
+  double perHour = falsePositives * 3600000.0 / millis;
+  printf("%d traces, %.0f minutes replayed, %d false positives (%.1f per hour)\n", files, millis / 60000.0,
+         falsePositives, perHour);
+  expect(perHour <= MAX_FALSE_PER_HOUR, "%.1f false positives per hour, at most %d allowed", perHour,
+         MAX_FALSE_PER_HOUR);
+}
+
+static uint32_t sleptTm = 0;
+static bool sleptInAttract = false;
+
+// The first sleep is noted, then the board is picked up
+static void pickUp() {
+  if (sleptTm == 0) {
+    sleptTm = cycleTimer.millis();
+    sleptInAttract = controller._input == &autoplayer;
+  }
+  host_millis += 2000;
+  hostTilt(0.8, 0.0);
+}
+
+// Runs the sketch from power on with the board left alone, and returns
+// how long after the last change to the board it went to sleep
+static uint32_t leftAlone(int noise) {
+  hostTilt(0.0, 0.0);
+  host_adc_noise = noise;
+  setup();
+  lastBoardChangeTm = cycleTimer.millis(); // As at power on, not the last run's
+  host_clock_micros = 50; // The sketch's loops take time
+  host_sleep_hook = pickUp;
+  sleptTm = 0;
+
+  // Idle time counts from the last change to the board
+  uint32_t start = lastBoardChangeTm;
+  while (sleptTm == 0 && cycleTimer.millis() - start < 2 * sleepTimeout) {
+    loop();
+  }
+
+  host_clock_micros = 0;
+  host_sleep_hook = 0;
+  host_adc_noise = 0;
+
+  expect(sleptTm != 0, "a board left alone never slept");
+  expect(sleptInAttract, "a board left alone slept without playing attract mode");
+  return sleptTm - start;
+}
+
+// Times are on the clock that keeps time through show(), and must be
+// right within a second
+static void idle() {
+  uint32_t slept = leftAlone(0);
+  expect(slept >= attractTimeout + STILL_TIME && slept < attractTimeout + STILL_TIME + 1000,
+         "a still board slept after %u ms, expected attract mode from %u ms and sleep %u ms later", slept,
+         attractTimeout, STILL_TIME);
+  printf("left still: attract mode from %u ms, slept at %u ms\n", attractTimeout, slept);
+
+  slept = leftAlone(10);
+  expect(slept >= sleepTimeout && slept < sleepTimeout + 1000,
+         "a vibrating board slept after %u ms, expected %u ms", slept, sleepTimeout);
+  printf("vibrating: slept at %u ms\n", slept);
+}
+
+// Shakes the board as the gesture detector would report it
+static byte shake(byte level) {
+  controller.setLevel(level);
+  gestures._pending = Gesture_Shake;
+  loop();
+  expect(controller.levelIndex() == level, "shaking level %d left it for level %d", level, controller.levelIndex());
+  return controller.balls().count;
+}
+
+static void multiBall() {
+  setup();
+  expect(controller.balls().count == BALL_COUNT, "%d balls at power on, expected %d", controller.balls().count,
+         BALL_COUNT);
+
+  byte balls = shake(1);
+  expect(balls == BALL_COUNT, "shaking level 1 gave %d balls, expected %d", balls, BALL_COUNT);
+  balls = shake(0);
+  expect(balls == MULTI_BALL_COUNT, "shaking level 0 gave %d balls, expected multi-ball's %d", balls,
+         MULTI_BALL_COUNT);
+  balls = shake(1);
+  expect(balls == MULTI_BALL_COUNT, "multi-ball left level 1 with %d balls", balls);
+  balls = shake(0);
+  expect(balls == BALL_COUNT, "shaking level 0 again gave %d balls, expected %d", balls, BALL_COUNT);
+  printf("multi-ball: %d balls, switched on level 0\n", MULTI_BALL_COUNT);
+}
+
+int main(int argc, char** argv) {
+  idle();
+  multiBall();
+  traces(argc > 1 ? argv[1] : "build/traces");
+  return finish("GestureTest");
+}
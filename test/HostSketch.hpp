@@ -0,0 +1,134 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Builds the whole sketch for the host, against the stand-ins in stubs/,
+// so the tests here can drive it. Include this once, from the test's
+// source file, and call setup() before using the sketch's globals.
+//
+// Tests check the sketch's internals, so its classes are opened up.
+
+#ifndef _HOSTSKETCH_HPP_
+#define _HOSTSKETCH_HPP_
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include <x86intrin.h>
+
+#define protected public
+#define private public
+
+uint32_t host_millis = 0;
+uint32_t host_micros_extra = 0;
+uint32_t host_lost_us = 0;
+int host_adc[3] = { 512, 508, 536 };
+uint32_t host_adc_micros = 0;
+int host_adc_noise = 0;
+uint32_t host_show_count = 0;
+uint32_t host_eeprom_writes = 0;
+uint8_t host_eeprom[1024];
+void (*host_sleep_hook)() = 0;
+void (*host_show_hook)(const uint8_t* pixels) = 0;
+volatile uint8_t host_regs[32];
+volatile uint16_t host_regs16[4];
+uintptr_t host_sp = 0;
+char __heap_start;
+char* __brkval = 0;
+bool host_uart_model = false;
+FILE* host_serial_file = 0;
+HardwareSerial Serial;
+
+#include "../LEDbyrinth.ino"
+
+EEPROMClass EEPROM;
+
+// Timer1 counts at 2 MHz of host time, including the time show() spends
+// with interrupts off, and runs the overflow ISR as it wraps
+HostTcnt1 host_tcnt1;
+static uint64_t host_timer1_base = 0;
+
+// Host time that passes each time the sketch reads Timer1, standing in for
+// the work between reads. Loops that wait on the clock need it.
+uint32_t host_clock_micros = 0;
+
+// When set before setup(), Timer1 also counts the host's own cycles, one
+// tick per 8 of them, so CycleTimer::cycles() measures host cycles the way
+// it measures the AVR's. Time passed in delay() and show() still counts,
+// at 16 MHz, as the device would spend it waiting.
+bool host_cycle_clock = false;
+static uint64_t host_cycle_base = 0;
+
+static uint64_t hostTicks() {
+  uint64_t ticks = ((uint64_t)host_millis * 1000 + host_micros_extra + host_lost_us) * 2;
+  if (host_cycle_clock) {
+    if (!host_cycle_base) host_cycle_base = __rdtsc();
+    ticks += (__rdtsc() - host_cycle_base) / 8;
+  }
+  return ticks;
+}
+
+HostTcnt1::operator uint16_t() {
+  host_advance_micros(host_clock_micros);
+  uint64_t ticks = hostTicks();
+  while (host_timer1_base + 65536 <= ticks) {
+    host_timer1_base += 65536;
+    TIMER1_OVF_vect_isr();
+  }
+  return ticks - host_timer1_base;
+}
+
+HostTcnt1& HostTcnt1::operator=(uint16_t value) {
+  host_timer1_base = hostTicks() - value;
+  return *this;
+}
+
+// Sets the raw readings for a board tilted by the angles, in radians,
+// using the range of each axis in Accelerometer.hpp
+void hostTilt(double x, double y) {
+  double gx = sin(x);
+  double gy = sin(y);
+  double gz = sqrt(max(0.0, 1 - gx * gx - gy * gy));
+  host_adc[0] = lround((xRawMin + xRawMax) / 2.0 + gx * (xRawMax - xRawMin) / 2.0);
+  host_adc[1] = lround((yRawMin + yRawMax) / 2.0 + gy * (yRawMax - yRawMin) / 2.0);
+  host_adc[2] = lround((zRawMin + zRawMax) / 2.0 + gz * (zRawMax - zRawMin) / 2.0);
+}
+
+static int hostFailures = 0;
+
+// Counts a failure and prints the message if the condition doesn't hold.
+// Only the first few failures are printed.
+bool expect(bool condition, const char* format, ...) {
+  if (condition) return true;
+  if (++hostFailures <= 10) {
+    va_list args;
+    va_start(args, format);
+    printf("FAIL: ");
+    vprintf(format, args);
+    printf("\n");
+    va_end(args);
+  }
+  return false;
+}
+
+// What main() returns: 0 if every expectation held
+int finish(const char* name) {
+  printf("%s: %s (%d failures)\n", name, hostFailures ? "FAILED" : "ok", hostFailures);
+  return hostFailures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,154 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Generates mazes for thousands of seeds and checks each can be solved:
+// a search from the start that steps onto empty cells and follows
+// teleports must reach the exit without crossing a trap. Then checks that
+// a maze generated in the waits of the exit animation is shown as it's
+// drawn once loaded, and that cells off the board read as walls.
+
+#include "HostSketch.hpp"
+
+#include <time.h>
+
+#define SEEDS 20000
+
+static MazeLevel<> maze;
+
+// Cells reachable from the start, by breadth first search
+static bool solvable(Level<>& level) {
+  bool seen[MATRIX_HEIGHT][MATRIX_WIDTH] = {};
+  byte queue[MATRIX_WIDTH * MATRIX_HEIGHT];
+  int head = 0, tail = 0;
+
+  queue[tail++] = level.startY * MATRIX_WIDTH + level.startX;
+  seen[level.startY][level.startX] = true;
+
+  while (head < tail) {
+    int x = queue[head] % MATRIX_WIDTH;
+    int y = queue[head++] / MATRIX_WIDTH;
+    byte cell = level.cellAt(x, y);
+    if (cell == Cell_Exit) return true;
+
+    if (Cell::event(cell) == Event_Teleport) {
+      byte destination = cell - Cell_PointerBase;
+      expect(level.cellAt(destination % MATRIX_WIDTH, destination / MATRIX_WIDTH) == Cell_Empty,
+             "teleport to a cell that isn't empty");
+      x = destination % MATRIX_WIDTH;
+      y = destination / MATRIX_WIDTH;
+    }
+
+    const int dx[] = { 1, -1, 0, 0 };
+    const int dy[] = { 0, 0, 1, -1 };
+    for (int k = 0; k < 4; ++k) {
+      int nx = x + dx[k];
+      int ny = y + dy[k];
+      if (nx < 0 || ny < 0 || nx >= MATRIX_WIDTH || ny >= MATRIX_HEIGHT || seen[ny][nx]) continue;
+      byte next = level.cellAt(nx, ny);
+      if (Cell::solid(next) || Cell::event(next) == Event_Trap) continue;
+      seen[ny][nx] = true;
+      queue[tail++] = ny * MATRIX_WIDTH + nx;
+    }
+  }
+  return false;
+}
+
+int main() {
+  long traps = 0, teleports = 0;
+  double totalMicros = 0, worstMicros = 0;
+
+  for (uint16_t seed = 1; seed <= SEEDS; ++seed) {
+    timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    Level<> level = maze.generate(seed);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double micros = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+    totalMicros += micros;
+    worstMicros = max(worstMicros, micros);
+
+    int exits = 0;
+    for (int y = 0; y < MATRIX_HEIGHT; ++y) {
+      for (int x = 0; x < MATRIX_WIDTH; ++x) {
+        byte cell = level.cellAt(x, y);
+        exits += cell == Cell_Exit;
+        traps += cell == Cell_Trap;
+        teleports += Cell::event(cell) == Event_Teleport;
+        bool edge = x == 0 || y == 0 || x == MATRIX_WIDTH - 1 || y == MATRIX_HEIGHT - 1;
+        if (edge) expect(cell == Cell_Wall, "seed %u: open edge at %d,%d", seed, x, y);
+      }
+    }
+
+    expect(exits == 1, "seed %u: %d exits", seed, exits);
+    expect(level.cellAt(level.startX, level.startY) == Cell_Empty, "seed %u: start isn't empty", seed);
+    expect(solvable(level), "seed %u: exit can't be reached", seed);
+
+    // The same seed always makes the same maze
+    if (seed % 1000 == 0) {
+      byte before[MATRIX_HEIGHT][MATRIX_WIDTH];
+      for (int y = 0; y < MATRIX_HEIGHT; ++y)
+        for (int x = 0; x < MATRIX_WIDTH; ++x) before[y][x] = level.cellAt(x, y);
+      maze.generate(seed + 1);
+      Level<> again = maze.generate(seed);
+      for (int y = 0; y < MATRIX_HEIGHT; ++y)
+        for (int x = 0; x < MATRIX_WIDTH; ++x)
+          expect(again.cellAt(x, y) == before[y][x], "seed %u: not repeatable at %d,%d", seed, x, y);
+    }
+  }
+
+  printf("%d seeds, %.2f traps and %.2f teleports a maze, %u bytes of RAM\n",
+         SEEDS, double(traps) / SEEDS, double(teleports) / SEEDS, unsigned(sizeof(maze)));
+  printf("generate() on this host: %.1f us average, %.1f us worst\n", totalMicros / SEEDS, worstMicros);
+
+  setup();
+  uint8_t* pixels = pictureFrame.matrix().getPixels();
+  const int bytes = MATRIX_WIDTH * MATRIX_HEIGHT * 3;
+  for (byte index = levels.count; index < levels.count + 4; ++index) {
+    controller.setLevel(1);
+    controller.exitTo(index, MATRIX_WIDTH / 2, MATRIX_HEIGHT / 2);
+    byte shown[bytes];
+    memcpy(shown, pixels, bytes);
+
+    controller.drawBoard();
+    controller.drawBalls();
+    expect(!memcmp(shown, pixels, bytes), "level %d: the frame readied during the exit differs from the level", index);
+  }
+
+  // Off the board is wall, on every side, for stored levels and mazes
+  for (byte index = 0; index < levels.count + 1; ++index) {
+    Level<> level = index < levels.count ? levels.level(index) : maze.generate(1);
+    for (int x = -1; x <= MATRIX_WIDTH; ++x) {
+      expect(level.cellAt(x, -1) == Cell_Wall && level.cellAt(x, MATRIX_HEIGHT) == Cell_Wall,
+             "level %d: off the board at column %d isn't wall", index, x);
+    }
+    for (int y = -1; y <= MATRIX_HEIGHT; ++y) {
+      expect(level.cellAt(-1, y) == Cell_Wall && level.cellAt(MATRIX_WIDTH, y) == Cell_Wall,
+             "level %d: off the board at row %d isn't wall", index, y);
+    }
+  }
+
+  // The last stored level leads on to the mazes, or back around
+  controller.setLevel(levels.count - 1);
+#ifdef ENDLESS_MAZES
+  expect(controller.followingLevel() == levels.count, "the last stored level led to %d, not the first maze",
+         controller.followingLevel());
+#else
+  expect(controller.followingLevel() == 1, "the last stored level led to %d, not level 1", controller.followingLevel());
+#endif
+  return finish("MazeLevelTest");
+}
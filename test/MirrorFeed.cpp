@@ -0,0 +1,91 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Runs the sketch with MIRROR defined and writes the telemetry stream to
+// the file named by its argument, for mirror_test.py. Each frame shown is
+// printed to standard output as its number and channels in hex, so the
+// test can check what the viewer rebuilds. The serial port is modeled, so
+// frames merge when they change faster than it carries them.
+//
+// The level's exit animation runs first, and how much of the port it
+// takes is printed. Then the board stays still while the changes drain,
+// and then a few pixels change at a time for long enough that a keyframe
+// falls among frames sent as runs.
+
+#include "HostSketch.hpp"
+
+static FrameMatrix& matrix = pictureFrame.matrix();
+
+static void printFrame(const uint8_t* pixels) {
+  // Numbered as FrameMatrix::show() will number it once this returns
+  printf("%u ", (uint16_t)(matrix._mirror._frame + 1));
+  for (uint16_t i = 0; i < matrix.numPixels() * 3; ++i) {
+    printf("%02x", pixels[i]);
+  }
+  printf("\n");
+}
+
+// Lets the port carry what's left of the changes, as the main loop does
+static void drain() {
+  while (matrix._mirror._pending) {
+    host_millis += 10;
+    matrix.mirror();
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: MirrorFeed STREAM\n");
+    return 2;
+  }
+
+  setup();
+  host_serial_file = fopen(argv[1], "wb");
+  host_uart_model = true;
+  host_show_hook = printFrame;
+
+  long startBytes = ftell(host_serial_file);
+  uint32_t start = cycleTimer.micros();
+  uint16_t startFrame = matrix._mirror._frame + 1;
+  uint16_t dropped = telemetry.dropped();
+  controller.animateExit(MATRIX_WIDTH / 2, MATRIX_HEIGHT / 2);
+  long bytes = ftell(host_serial_file) - startBytes;
+  uint32_t elapsed = cycleTimer.micros() - start;
+  printf("# exit frames %u to %u, %ld bytes in %u ms, %ld bytes/s of %d, %u records dropped\n",
+         startFrame, matrix._mirror._frame, bytes, elapsed / 1000, bytes * 1000000 / elapsed,
+         TELEMETRY_BAUD / 10, telemetry.dropped() - dropped);
+  drain();
+
+  // A small change each tenth of a second, past the next keyframe
+  printf("# runs from byte %ld\n", ftell(host_serial_file));
+  for (int i = 0; i < 80; ++i) {
+    matrix.drawPixel(i % MATRIX_WIDTH, i / MATRIX_WIDTH, Cell::color(Cell_Exit));
+    matrix.drawPixel(MATRIX_WIDTH - 1 - i % MATRIX_WIDTH, MATRIX_HEIGHT - 1, i & 1 ? 0 : 0xFFFF);
+    matrix.show();
+    for (int j = 0; j < 10; ++j) {
+      host_millis += 10;
+      matrix.mirror();
+    }
+  }
+  drain();
+
+  fclose(host_serial_file);
+  host_serial_file = 0;
+  return 0;
+}
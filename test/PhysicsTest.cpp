@@ -0,0 +1,157 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Checks that the balls move the same way however often update() is
+// called. Each run plays a level with a steady tilt under a different
+// schedule of calls. After every call the balls must be where a reference
+// run, which calls simulateStep() directly, had them after some step, and
+// those steps must come in order.
+//
+// Events that play an animation restart the clock and drop the time not
+// yet simulated, so a run can skip ahead of the reference but never leave
+// its path.
+
+#include <vector>
+
+#include "HostSketch.hpp"
+
+#define RUN_STEPS 300
+
+typedef std::vector<float> Snapshot;
+
+static Snapshot snapshot() {
+  Snapshot s;
+  for (byte i = 0; i < controller._balls.count; ++i) {
+    s.push_back(controller._balls.x[i]);
+    s.push_back(controller._balls.y[i]);
+    s.push_back(controller._balls.v_x[i]);
+    s.push_back(controller._balls.v_y[i]);
+  }
+  return s;
+}
+
+typedef uint32_t (*Schedule)(uint32_t call);
+
+static uint32_t every7(uint32_t) { return 7; }
+static uint32_t every23(uint32_t) { return 23; }
+static uint32_t every49(uint32_t) { return 49; }
+static uint32_t uneven(uint32_t call) { return 1 + (call * 2654435761u >> 16) % 45; }
+
+// The balls after each step, or nothing if the level ended. It runs a
+// call's worth of steps past RUN_STEPS, for runs that pass the end.
+static std::vector<Snapshot> reference(byte level, InputProvider& input) {
+  std::vector<Snapshot> steps;
+  controller.setTrapCount(0);
+  controller.setLevel(level);
+  for (int i = 0; i < RUN_STEPS + controller.MAX_STEPS; ++i) {
+    controller.simulateStep(-input.x(), -input.y());
+    if (controller._levelIndex != level) return std::vector<Snapshot>();
+    steps.push_back(snapshot());
+  }
+  return steps;
+}
+
+// Plays the level under the schedule until the balls pass RUN_STEPS steps
+// of the reference, or come to rest where it does. Returns how many calls
+// there were.
+//
+// Until something restarts the clock or a call comes too late to catch
+// up, the run must also be exactly as many steps in as the time passed.
+static int play(byte level, InputProvider& input, Schedule schedule, uint32_t startMillis,
+                const std::vector<Snapshot>& steps, const char* name) {
+  controller.setTrapCount(0);
+  controller.setLevel(level);
+  controller.setInput(input);
+
+  // Start the clock where the run asks, to cross the wrap around
+  timer1Millis = startMillis;
+  controller.restartClock();
+
+  uint32_t start = cycleTimer.millis();
+  bool onTime = true;
+  size_t matched = 0;
+  Snapshot last = snapshot();
+  for (uint32_t call = 0; call < 10000; ++call) {
+    host_millis += schedule(call);
+    uint32_t before = cycleTimer.millis();
+    onTime &= controller._pendingTm + before - controller._lastUpdateTm <= controller.MAX_STEPS * controller.PERIOD;
+    controller.update();
+    onTime &= controller._lastUpdateTm == before;
+    if (!expect(controller._levelIndex == level, "level %d %s: the level ended", level, name)) return call;
+
+    Snapshot now = snapshot();
+    if (now == steps.back()) return call;
+    if (now == last) continue;
+    last = now;
+
+    while (matched < steps.size() && steps[matched] != now) ++matched;
+    if (!expect(matched < steps.size(), "level %d %s: the balls left the reference's path after %u calls",
+                level, name, call)) return call;
+    ++matched;
+
+    uint32_t due = (before - start - controller._pendingTm) / controller.PERIOD;
+    if (onTime && !expect(matched == due, "level %d %s: %u steps run in %u ms", level, name, matched,
+                          before - start)) return call;
+    if (matched >= RUN_STEPS) return call;
+  }
+
+  expect(false, "level %d %s: the balls never reached the end", level, name);
+  return 10000;
+}
+
+int main() {
+  setup();
+
+  const Schedule schedules[] = { every7, every23, every49, uneven };
+  const char* names[] = { "every 7 ms", "every 23 ms", "every 49 ms", "uneven", "uneven across wrap around" };
+  const float tilts[][2] = { { 0.3, 0.0 }, { -0.3, 0.1 }, { 0.05, 0.4 }, { -0.2, -0.25 } };
+  int runs = 0;
+  long calls = 0;
+
+  for (byte level = 0; level < levels.count; ++level) {
+    for (size_t t = 0; t < sizeof(tilts) / sizeof(tilts[0]); ++t) {
+      SteadyInput input(tilts[t][0], tilts[t][1]);
+      std::vector<Snapshot> steps = reference(level, input);
+      if (steps.empty()) continue;
+
+      for (int k = 0; k < 5; ++k) {
+        Schedule schedule = k < 4 ? schedules[k] : uneven;
+        uint32_t startMillis = k < 4 ? 0 : 0xFFFFFFFF - 1500;
+        calls += play(level, input, schedule, startMillis, steps, names[k]);
+        ++runs;
+      }
+    }
+  }
+
+  // A long stall runs MAX_STEPS steps and drops the rest
+  SteadyInput input(0.3, 0.0);
+  std::vector<Snapshot> steps = reference(2, input);
+  controller.setTrapCount(0);
+  controller.setLevel(2);
+  controller.setInput(input);
+  controller.restartClock();
+  host_millis += 500;
+  controller.update();
+  expect(controller._pendingTm == 0, "a stall left %u ms to simulate", controller._pendingTm);
+  expect(steps.size() > controller.MAX_STEPS && snapshot() == steps[controller.MAX_STEPS - 1], "a stall didn't run exactly MAX_STEPS steps");
+
+  expect(runs >= 100, "only %d runs", runs);
+  printf("%d runs of %d steps, %ld calls to update()\n", runs, RUN_STEPS, calls);
+  return finish("PhysicsTest");
+}
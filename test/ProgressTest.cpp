@@ -0,0 +1,127 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Checks the progress log against a simulated EEPROM that counts writes:
+// records survive a restart, each session's writes are bounded and saves
+// past the bound are reported, wear is spread across the slots, and a
+// record torn by power loss falls back to the one before.
+
+#include <stddef.h>
+
+#include "HostSketch.hpp"
+
+#define SESSIONS 3000
+
+// Writes to each EEPROM byte so far, found by comparing it before and
+// after every save
+static uint32_t wear[1024];
+
+static bool save(Progress& p, byte level, byte trapCount) {
+  uint8_t before[sizeof(host_eeprom)];
+  memcpy(before, host_eeprom, sizeof(before));
+  bool saved = p.save(level, trapCount);
+  for (size_t i = 0; i < sizeof(before); ++i) {
+    wear[i] += before[i] != host_eeprom[i];
+  }
+  return saved;
+}
+
+int main() {
+  memset(host_eeprom, 0xFF, sizeof(host_eeprom));
+
+  Progress fresh;
+  expect(!fresh.load() && fresh.level() == 1 && fresh.trapCount() == 0, "erased EEPROM didn't start the game");
+
+  // Each session loads, plays through a few levels and saves at every
+  // transition, as a restart after power loss would
+  uint32_t saves = 0;
+  for (int s = 0; s < SESSIONS; ++s) {
+    Progress p;
+    bool loaded = p.load();
+    expect(s == 0 || loaded, "session %d: no record found", s);
+
+    byte level = (s * 7) % 12;
+    byte trapCount = s % 5;
+    for (int i = 0; i < 3; ++i, level = (level + 1) % 12) {
+      saves += save(p, level, trapCount);
+    }
+    byte last = (level + 11) % 12;
+    expect(!save(p, last, trapCount), "session %d: an unchanged save wrote", s);
+
+    Progress restarted;
+    expect(restarted.load() && restarted.level() == last && restarted.trapCount() == trapCount,
+           "session %d: saved level %d trap count %d, loaded %d %d", s, last, trapCount, restarted.level(),
+           restarted.trapCount());
+    expect(restarted.unlocked(last) && restarted.unlocked(1), "session %d: unlocked levels lost", s);
+  }
+
+  // One session can't write more than PROGRESS_MAX_WRITES records, and
+  // says so over telemetry for each save refused. Progress is still kept.
+  Progress busy;
+  busy.load();
+  host_serial_file = tmpfile();
+  uint32_t before = host_eeprom_writes;
+  int written = 0;
+  for (int i = 0; i < 1000; ++i) {
+    written += save(busy, i % 12, i % 3);
+  }
+  expect(written == PROGRESS_MAX_WRITES, "a session wrote %d records", written);
+  expect(host_eeprom_writes - before <= PROGRESS_MAX_WRITES * sizeof(Progress::Record),
+         "a session wrote %u bytes", host_eeprom_writes - before);
+  expect(busy.level() == 999 % 12 && busy.trapCount() == 999 % 3, "progress past the cap was lost");
+
+  int reported = 0, refused = 0;
+  rewind(host_serial_file);
+  int c;
+  while ((c = fgetc(host_serial_file)) != EOF) {
+    if (c != TELEMETRY_SYNC) continue;
+    byte header[3], payload[4];
+    if (fread(header, 1, 3, host_serial_file) != 3 || header[1] != Record_Progress || header[2] != 4) continue;
+    if (fread(payload, 1, 4, host_serial_file) != 4) break;
+    ++reported;
+    refused += !payload[3];
+    expect(payload[2] == min(reported, PROGRESS_MAX_WRITES), "save %d reported %d writes", reported, payload[2]);
+  }
+  fclose(host_serial_file);
+  host_serial_file = 0;
+  expect(reported == 1000 && refused == 1000 - PROGRESS_MAX_WRITES, "%d saves reported, %d refused", reported, refused);
+
+  // Wear is spread evenly over the slots
+  uint32_t most = 0;
+  for (size_t i = 0; i < sizeof(host_eeprom); ++i) {
+    most = max(most, wear[i]);
+  }
+  saves += written;
+  uint32_t fairShare = (saves + PROGRESS_SLOTS - 1) / PROGRESS_SLOTS;
+  expect(most <= fairShare, "a byte was written %u times, a slot's share is %u", most, fairShare);
+
+  // Power lost part way through a record leaves the one before it
+  Progress torn;
+  torn.load();
+  byte previous = torn.level();
+  torn.save((previous + 1) % 12, 0);
+  int address = PROGRESS_ADDRESS + torn._slot * sizeof(Progress::Record);
+  host_eeprom[address + offsetof(Progress::Record, level)] ^= 0x5A;
+  Progress recovered;
+  expect(recovered.load() && recovered.level() == previous, "a torn record wasn't skipped");
+
+  printf("%d sessions, %u records, %u byte writes, at most %u writes to a byte (EEPROM is rated for 100000)\n",
+         SESSIONS, saves, host_eeprom_writes, most);
+  return finish("ProgressTest");
+}
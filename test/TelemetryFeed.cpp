@@ -0,0 +1,51 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Writes a known run of telemetry records to standard output through the
+// sketch's Telemetry, for telemetry_test.py to send through a pty and
+// decode. The serial port is modeled, so a burst that overflows its
+// buffer drops records the way the device would.
+
+#include "HostSketch.hpp"
+
+int main() {
+  host_serial_file = stdout;
+  host_uart_model = true;
+
+  telemetry.ball(0, 3.5, 7.25, 0.5, -0.25);
+  telemetry.level(4, 2);
+  telemetry.sensors(0.125, -0.25);
+  telemetry.benchmark(Benchmark_Update, 5, 123456);
+  host_millis += 100;
+  telemetry.clock(6700, -3);
+  telemetry.transition(3, true, 4567);
+  telemetry.invariant(Invariant_Solid | Invariant_Speed, 1, 9, 2.5, 11.75);
+  host_millis += 100;
+
+  // The port's 63 bytes of buffer hold ten gesture records, and the rest
+  // of the burst is dropped
+  for (byte i = 0; i < 12; ++i) {
+    telemetry.gesture(Gesture_DoubleTap);
+  }
+  host_millis += 100;
+
+  telemetry.timing(850, 1, 312);
+  telemetry.memory(412, 300);
+  return 0;
+}
@@ -0,0 +1,61 @@
+/*
+    Copyright 2019 Zach Vonler
+
+    This file is part of LEDbyrinth.
+
+    LEDbyrinth is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LEDbyrinth is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Host cycles for the two pauses around a level's exit animation: loading
+// started before its first frame, and what's left after its last, up to
+// the new level being shown. Every stored level and a few generated mazes
+// are loaded, each the best of a number of runs. Host cycles only compare
+// builds of the sketch with each other; on the device, Record_Transition
+// reports the second pause in micros.
+
+#include <x86intrin.h>
+
+#include "HostSketch.hpp"
+
+#define RUNS 50
+#define MAZES 4
+
+int main() {
+  setup();
+
+  unsigned long long totalBefore = 0, totalAfter = 0;
+  for (byte index = 0; index < levels.count + MAZES; ++index) {
+    unsigned long long bestBefore = ~0ull, bestAfter = ~0ull;
+    for (int run = 0; run < RUNS; ++run) {
+      controller.setLevel(index == 0 ? 1 : 0);
+
+      unsigned long long start = __rdtsc();
+      controller.beginLoad(index);
+      bestBefore = min(bestBefore, __rdtsc() - start);
+
+      controller.animateExit(MATRIX_WIDTH / 2, MATRIX_HEIGHT / 2);
+
+      start = __rdtsc();
+      controller.finishLoad();
+      bestAfter = min(bestAfter, __rdtsc() - start);
+    }
+
+    printf("level %2d: before the animation %6llu, after %6llu\n", index, bestBefore, bestAfter);
+    totalBefore += bestBefore;
+    totalAfter += bestAfter;
+  }
+
+  printf("all levels: before the animation %llu, after %llu host cycles\n", totalBefore, totalAfter);
+  return finish("TransitionBench");
+}
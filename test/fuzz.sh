@@ -0,0 +1,29 @@
+#!/bin/sh
+#
+# Fuzzes the physics on the host across several processes.
+#
+#   fuzz.sh [SEEDS [JOBS]]
+#
+# tries seeds 1 to SEEDS, 4096 by default, on every level, split between
+# JOBS processes, one per CPU by default. Exits non-zero if any sequence
+# broke an invariant.
+
+SEEDS=${1:-4096}
+JOBS=${2:-$(nproc)}
+
+cd "$(dirname "$0")" && make -s build/FuzzTest || exit 1
+
+status=0
+pids=
+for shard in $(seq 0 $((JOBS - 1))); do
+  build/FuzzTest 1 "$SEEDS" "$shard" "$JOBS" > "build/fuzz.$shard.log" &
+  pids="$pids $!"
+done
+for pid in $pids; do
+  wait "$pid" || status=1
+done
+
+cat build/fuzz.*.log | grep -v '^FuzzTest'
+rm -f build/fuzz.*.log
+[ $status = 0 ] && echo "fuzz: ok" || echo "fuzz: FAILED"
+exit $status
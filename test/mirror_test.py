@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+#
+#   Copyright 2019 Zach Vonler
+#
+#   This file is part of LEDbyrinth.
+#
+#   LEDbyrinth is free software: you can redistribute it and/or modify
+#   it under the terms of the GNU General Public License as published by
+#   the Free Software Foundation, either version 3 of the License, or
+#   (at your option) any later version.
+#
+#   LEDbyrinth is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Rebuilds the frames mirrored by a run of the sketch with tools/mirror.py's
+Mirror and checks each against the frame shown, from the start of the
+stream and from partway in, where the viewer has to wait for a keyframe.
+
+Usage: mirror_test.py FEED
+
+FEED is the MirrorFeed program built from MirrorFeed.cpp.
+"""
+
+import os
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "tools"))
+
+import mirror
+import telemetry
+
+failures = 0
+
+
+def expect(condition, message):
+    global failures
+    if not condition:
+        failures += 1
+        print("FAIL: " + message)
+
+
+def replay(stream, shown):
+    """Feeds the stream to a Mirror, checking every frame it completes once
+    synced against the frames shown. Returns the Mirror, the frames it
+    completed before it synced, the numbers of the keyframes and the
+    number of pixels sent in runs for each frame that wasn't one, and the
+    numbers of all the frames completed."""
+    decoder = telemetry.Decoder()
+    viewer = mirror.Mirror()
+    unsynced = 0
+    keyframes = []
+    numbers = []
+    runs = []
+    pixels = 0
+    for name, fields in decoder.feed(stream):
+        if name == "pixels":
+            pixels += len(fields["channels"]) // 6
+        if not viewer.apply(name, fields):
+            continue
+        numbers.append(fields["number"])
+        if fields["keyframe"]:
+            keyframes.append(fields["number"])
+        elif viewer.synced:
+            runs.append(pixels)
+        pixels = 0
+        if not viewer.synced:
+            unsynced += 1
+            continue
+        number = fields["number"]
+        expect(bytes(viewer.channels) == shown.get(number), "frame %d wasn't rebuilt as it was shown" % number)
+    return viewer, unsynced, keyframes, runs, numbers
+
+
+def main(argv):
+    with tempfile.NamedTemporaryFile() as stream_file:
+        output = subprocess.run([argv[1], stream_file.name], stdout=subprocess.PIPE, check=True, text=True).stdout
+        stream = stream_file.read()
+
+    shown = {}
+    notes = []
+    for line in output.splitlines():
+        if line.startswith("#"):
+            notes.append(line[2:])
+        else:
+            number, channels = line.split()
+            shown[int(number)] = bytes.fromhex(channels)
+    exit_first, exit_last = (int(word.rstrip(",")) for word in notes[0].split()[2:5:2])
+    runs_start = int(notes[1].split()[-1])
+
+    # From the start
+    viewer, unsynced, keyframes, runs, numbers = replay(stream, shown)
+    expect(viewer.synced, "never synced")
+    expect(len(keyframes) >= 2, "%d keyframes" % len(keyframes))
+    # A change of brightness resends every pixel too
+    expect(runs and sorted(runs)[len(runs) // 2] < mirror.WIDTH * mirror.HEIGHT // 4,
+           "frames after a keyframe weren't sent as runs of their changes: %s" % runs)
+    expect(bytes(viewer.channels) == shown[max(shown)], "the last frame shown wasn't rebuilt")
+    lines = viewer.render().split("\n")
+    expect(len(lines) == mirror.HEIGHT + 2, "rendered %d lines" % len(lines))
+
+    # Joining partway into a record, between keyframes
+    joined, joined_unsynced, _, _, _ = replay(stream[runs_start + 3:], shown)
+    expect(joined_unsynced > 0, "synced without waiting for a keyframe")
+    expect(joined.synced and bytes(joined.channels) == shown[max(shown)], "didn't sync after joining partway")
+    expect("waiting for a keyframe" not in joined.render(), "still waiting for a keyframe")
+
+    for note in notes:
+        print(note)
+    print("%d of the exit's %d frames rebuilt" % (len([n for n in numbers if exit_first <= n <= exit_last]),
+                                              exit_last - exit_first + 1))
+    print("%d frames shown, %d rebuilt, %d keyframes, %d frames rebuilt before syncing when joined partway"
+          % (len(shown), viewer.frames, len(keyframes), joined_unsynced))
+    print("mirror_test: %s (%d failures)" % ("FAILED" if failures else "ok", failures))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
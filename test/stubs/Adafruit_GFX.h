@@ -0,0 +1,23 @@
+#pragma once
+#include <Arduino.h>
+class Adafruit_GFX {
+ public:
+  Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+  virtual ~Adafruit_GFX() {}
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+  virtual void fillScreen(uint16_t color) { for (int y = 0; y < _height; ++y) for (int x = 0; x < _width; ++x) drawPixel(x, y, color); }
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t c) { for (int i = 0; i < h; ++i) drawPixel(x, y + i, c); }
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t c) { for (int i = 0; i < w; ++i) drawPixel(x + i, y, c); }
+  void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c) { drawFastHLine(x, y, w, c); drawFastHLine(x, y + h - 1, w, c); drawFastVLine(x, y, h, c); drawFastVLine(x + w - 1, y, h, c); }
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c) { for (int i = 0; i < w; ++i) drawFastVLine(x + i, y, h, c); }
+  void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t c) {
+    for (int y = -r; y <= r; ++y) for (int x = -r; x <= r; ++x) { int d = x * x + y * y; if (d <= r * r && d > (r - 1) * (r - 1)) drawPixel(x0 + x, y0 + y, c); }
+  }
+  void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t c) {
+    for (int y = -r; y <= r; ++y) for (int x = -r; x <= r; ++x) if (x * x + y * y <= r * r) drawPixel(x0 + x, y0 + y, c);
+  }
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+ protected:
+  int16_t _width, _height;
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include <Adafruit_GFX.h>
+#include <Adafruit_NeoPixel.h>
+#define NEO_MATRIX_TOP 0x00
+#define NEO_MATRIX_LEFT 0x00
+#define NEO_MATRIX_ROWS 0x00
+#define NEO_MATRIX_ZIGZAG 0x08
+class Adafruit_NeoMatrix : public Adafruit_GFX, public Adafruit_NeoPixel {
+ public:
+  Adafruit_NeoMatrix(int w, int h, uint8_t pin = 6, uint8_t matrixType = 0, neoPixelType ledType = NEO_GRB + NEO_KHZ800)
+    : Adafruit_GFX(w, h), Adafruit_NeoPixel(w * h, pin, ledType), type(matrixType) {}
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height)) return;
+    uint16_t n = remapFn ? remapFn(x, y) : y * _width + ((y & 1) ? (_width - 1 - x) : x);
+    setPixelColor(n, expandColor(color));
+  }
+  void fillScreen(uint16_t color) override {
+    uint32_t c = expandColor(color);
+    for (uint16_t i = 0; i < numLEDs; ++i) setPixelColor(i, c);
+  }
+  void setRemapFunction(uint16_t (*fn)(uint16_t, uint16_t)) { remapFn = fn; }
+  static uint16_t Color(uint8_t r, uint8_t g, uint8_t b) { return ((uint16_t)(r & 0xF8) << 8) | ((uint16_t)(g & 0xFC) << 3) | (b >> 3); }
+  static uint32_t expandColor(uint16_t color) {
+    uint32_t r = (color >> 11) & 0x1F, g = (color >> 5) & 0x3F, b = color & 0x1F;
+    return ((r * 255 / 31) << 16) | ((g * 255 / 63) << 8) | (b * 255 / 31);
+  }
+ private:
+  uint8_t type;
+  uint16_t (*remapFn)(uint16_t, uint16_t) = 0;
+};
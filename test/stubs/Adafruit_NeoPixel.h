@@ -0,0 +1,54 @@
+#pragma once
+#include <Arduino.h>
+#include <stdlib.h>
+typedef uint16_t neoPixelType;
+#define NEO_GRB 0x52
+#define NEO_KHZ800 0
+extern uint32_t host_show_count, host_lost_us;
+// Showing calls host_show_hook, if a test has set one, with the frame sent
+extern void (*host_show_hook)(const uint8_t* pixels);
+class Adafruit_NeoPixel {
+ public:
+  Adafruit_NeoPixel(uint16_t n, uint8_t = 6, neoPixelType = NEO_GRB + NEO_KHZ800) : numLEDs(n), brightness(0) {
+    pixels = (uint8_t*)calloc(n * 3, 1);
+  }
+  void begin() {}
+  // Interrupts are off while sending, so millis() only catches one tick of it
+  void show() {
+    ++host_show_count; host_millis += 1; host_lost_us += numLEDs * 30 - 1000;
+    if (host_show_hook) host_show_hook(pixels);
+  }
+  void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) {
+    if (n >= numLEDs) return;
+    if (brightness) { r = (r * brightness) >> 8; g = (g * brightness) >> 8; b = (b * brightness) >> 8; }
+    uint8_t* p = &pixels[n * 3]; p[0] = g; p[1] = r; p[2] = b;
+  }
+  void setPixelColor(uint16_t n, uint32_t c) { setPixelColor(n, (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c); }
+  void setBrightness(uint8_t b) {
+    uint8_t newBrightness = b + 1;
+    if (newBrightness != brightness) {
+      uint8_t c, *ptr = pixels, oldBrightness = brightness - 1;
+      uint16_t scale;
+      if (oldBrightness == 0) scale = 0;
+      else if (b == 255) scale = 65535 / oldBrightness;
+      else scale = (((uint16_t)newBrightness << 8) - 1) / oldBrightness;
+      for (uint16_t i = 0; i < numLEDs * 3; i++) { c = *ptr; *ptr++ = (c * scale) >> 8; }
+      brightness = newBrightness;
+    }
+  }
+  uint8_t getBrightness() const { return brightness - 1; }
+  void clear() { memset(pixels, 0, numLEDs * 3); }
+  uint32_t getPixelColor(uint16_t n) const {
+    const uint8_t* p = &pixels[n * 3];
+    if (brightness) return (((uint32_t)(p[1] << 8) / brightness) << 16) | (((uint32_t)(p[0] << 8) / brightness) << 8) | ((uint32_t)(p[2] << 8) / brightness);
+    return ((uint32_t)p[1] << 16) | ((uint32_t)p[0] << 8) | p[2];
+  }
+  uint8_t* getPixels() const { return pixels; }
+  uint16_t numPixels() const { return numLEDs; }
+  bool canShow() { return true; }
+  static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) { return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b; }
+ protected:
+  uint16_t numLEDs;
+  uint8_t brightness;
+  uint8_t* pixels;
+};
@@ -0,0 +1,136 @@
+// Host stand-in for the parts of the Arduino core the sketch uses. Time
+// only passes when a test or a stub moves it: delay(), show() and, when
+// host_adc_micros or host_clock_micros is set, each analogRead() or read
+// of Timer1.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdio.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define F_CPU 16000000L
+#define PI 3.1415926535897932384626433832795
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_byte_near(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_word_near(p) (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+#define pgm_read_ptr(p) (*(void* const*)(p))
+#define memcpy_P memcpy
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define abs(x) ((x)>0?(x):-(x))
+#define bit(b) (1UL << (b))
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define EXTERNAL 0
+#define LED_BUILTIN 13
+#define A0 14
+#define A1 15
+#define A2 16
+#define RAMEND 0x8FF
+
+// The host clock, as whole millis plus micros into the next one
+extern uint32_t host_millis;
+extern uint32_t host_micros_extra;
+// Micros that pass with interrupts off, which millis() never sees
+extern uint32_t host_lost_us;
+// Raw readings returned for A0..A2, and how long each read takes
+extern int host_adc[3];
+extern uint32_t host_adc_micros;
+
+inline void host_advance_micros(uint32_t us) {
+  host_micros_extra += us;
+  host_millis += host_micros_extra / 1000;
+  host_micros_extra %= 1000;
+}
+
+inline unsigned long millis() { return host_millis; }
+inline unsigned long micros() { return host_millis * 1000UL + host_micros_extra; }
+inline void delay(unsigned long ms) { host_millis += ms; }
+inline void delayMicroseconds(unsigned int us) { host_advance_micros(us); }
+// Readings vary by up to host_adc_noise either way, like a board that's
+// vibrating a little
+extern int host_adc_noise;
+inline int analogRead(uint8_t pin) {
+  static uint32_t state = 1;
+  host_advance_micros(host_adc_micros);
+  state = state * 1103515245 + 12345;
+  int noise = host_adc_noise ? int((state >> 16) % (2 * host_adc_noise + 1)) - host_adc_noise : 0;
+  return host_adc[pin - A0] + noise;
+}
+inline void analogReference(uint8_t) {}
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline long map(long x, long in_min, long in_max, long out_min, long out_max) {
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+inline void noInterrupts() {}
+inline void interrupts() {}
+inline void cli() {}
+inline void sei() {}
+
+// Registers are plain variables. An ISR becomes a function the Timer1
+// stand-in calls as its count overflows.
+#define ISR(v) void v##_isr()
+extern volatile uint8_t host_regs[32];
+extern volatile uint16_t host_regs16[4];
+#define SREG host_regs[0]
+#define MCUSR host_regs[1]
+#define WDTCSR host_regs[2]
+#define ADCSRA host_regs[3]
+#define PRR host_regs[4]
+#define MCUCR host_regs[5]
+#define TCCR1A host_regs[6]
+#define TCCR1B host_regs[7]
+#define TIMSK1 host_regs[8]
+#define TIFR1 host_regs[9]
+// The stack pointer is pointer sized here, so MemoryProbe can cast it
+extern uintptr_t host_sp;
+#define SP host_sp
+struct HostTcnt1 { operator uint16_t(); HostTcnt1& operator=(uint16_t); };
+extern HostTcnt1 host_tcnt1;
+#define TCNT1 host_tcnt1
+#define WDCE 4
+#define WDE 3
+#define WDIE 6
+#define BODS 6
+#define BODSE 5
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define TOIE1 0
+#define TOV1 0
+
+// Bytes written go to host_serial_file, if set. With host_uart_model set,
+// the transmit buffer drains at 115200 baud of host time.
+extern bool host_uart_model;
+extern FILE* host_serial_file;
+class HardwareSerial {
+ public:
+  double level = 0; uint64_t lastUs = 0;
+  void drain() { uint64_t now = uint64_t(host_millis) * 1000 + host_micros_extra + host_lost_us; level -= (now - lastUs) * 0.01152; if (level < 0) level = 0; lastUs = now; }
+  void begin(unsigned long) {}
+  int availableForWrite() { if (!host_uart_model) return 63; drain(); return 63 - int(level + 0.999); }
+  size_t write(uint8_t b) { if (host_uart_model) { drain(); level += 1; } if (host_serial_file) fputc(b, host_serial_file); return 1; }
+  size_t write(const uint8_t* b, size_t n) { for (size_t i = 0; i < n; ++i) write(b[i]); return n; }
+  void flush() {}
+  operator bool() { return true; }
+};
+extern HardwareSerial Serial;
+#define SERIAL_TX_BUFFER_SIZE 64
+
+// The Arduino build declares the sketch's functions ahead of it
+void powerSave();
+void resumeLevel();
+void deepSleep();
+void attract();
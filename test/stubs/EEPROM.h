@@ -0,0 +1,11 @@
+#pragma once
+#include <Arduino.h>
+extern uint8_t host_eeprom[1024];
+extern uint32_t host_eeprom_writes;
+struct EEPROMClass {
+  uint8_t read(int i) { return host_eeprom[i]; }
+  void write(int i, uint8_t v) { host_eeprom[i] = v; ++host_eeprom_writes; }
+  void update(int i, uint8_t v) { if (host_eeprom[i] != v) write(i, v); }
+  uint16_t length() { return 1024; }
+};
+extern EEPROMClass EEPROM;
@@ -0,0 +1,9 @@
+#pragma once
+// Sleeping calls host_sleep_hook, if a test has set one, so the test can
+// pass the time asleep and wake the board
+#define SLEEP_MODE_PWR_DOWN 0
+extern void (*host_sleep_hook)();
+inline void set_sleep_mode(int) {}
+inline void sleep_enable() {}
+inline void sleep_disable() {}
+inline void sleep_cpu() { if (host_sleep_hook) host_sleep_hook(); }
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+#
+#   Copyright 2019 Zach Vonler
+#
+#   This file is part of LEDbyrinth.
+#
+#   LEDbyrinth is free software: you can redistribute it and/or modify
+#   it under the terms of the GNU General Public License as published by
+#   the Free Software Foundation, either version 3 of the License, or
+#   (at your option) any later version.
+#
+#   LEDbyrinth is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Sends records written by the sketch's Telemetry through a pty to
+tools/telemetry.py, as a serial port would, with one record cut short,
+one corrupted and noise between two others, and checks what it decodes.
+
+Usage: telemetry_test.py FEED
+
+FEED is the TelemetryFeed program built from TelemetryFeed.cpp.
+"""
+
+import os
+import select
+import subprocess
+import sys
+import time
+import tty
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TOOL = os.path.join(HERE, "..", "tools", "telemetry.py")
+SYNC = 0xA5
+
+failures = 0
+
+
+def expect(condition, message):
+    global failures
+    if not condition:
+        failures += 1
+        print("FAIL: " + message)
+
+
+def frames(stream):
+    """Splits a clean stream into its records' frames."""
+    result = []
+    i = 0
+    while i < len(stream):
+        assert stream[i] == SYNC
+        length = stream[i + 3]
+        result.append(stream[i:i + length + 5])
+        i += length + 5
+    return result
+
+
+def through_pty(stream, last):
+    """Writes the stream into a pty a few bytes at a time, with the decoder
+    reading the other end. Hangs up once it prints a line starting with
+    last, and returns the lines it printed, and what it printed to stderr."""
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    # The decoder opens the pty by path, as it would a serial port
+    decoder = subprocess.Popen([sys.executable, TOOL, "/dev/fd/%d" % slave, "115200"], pass_fds=[slave],
+                               stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+    os.close(slave)
+    for i in range(0, len(stream), 7):
+        os.write(master, stream[i:i + 7])
+
+    # Read unbuffered, so no line is left behind in a buffer select() can't
+    # see
+    output = b""
+    out = decoder.stdout.fileno()
+    deadline = time.time() + 10
+    while time.time() < deadline and not any(line.startswith(last) for line in output.decode().splitlines()):
+        if select.select([out], [], [], 0.1)[0]:
+            data = os.read(out, 4096)
+            if not data:
+                break
+            output += data
+
+    # Hanging up ends the decoder's stream
+    os.close(master)
+    rest, err = decoder.communicate(timeout=10)
+    lines = (output.decode() + rest).splitlines()
+    expect(decoder.returncode == 0, "decoder exited with %d: %s" % (decoder.returncode, err))
+    return lines, err
+
+
+def main(argv):
+    feed = subprocess.run([argv[1]], stdout=subprocess.PIPE, check=True).stdout
+    records = frames(feed)
+
+    # ball, level, sensors, benchmark, clock, transition, invariant, ten
+    # gestures, timing, memory
+    expect(len(records) == 19, "feed wrote %d records, not 19" % len(records))
+
+    damaged = bytearray()
+    for i, frame in enumerate(records):
+        if i == 1:
+            # Noise, with a stray sync byte, before the level record
+            damaged += bytes([0x00, SYNC, 0x01, 0x7F, 0x33])
+        if i == 2:
+            # The sensors record is cut off after its header
+            frame = frame[:4]
+        elif i == 5:
+            # The transition record arrives with a bad checksum
+            frame = frame[:-1] + bytes([(frame[-1] + 1) & 0xFF])
+        damaged += frame
+
+    lines, err = through_pty(bytes(damaged), "memory")
+    expected = [
+        "ball index=0 x=3.5 y=7.25 v_x=0.5 v_y=-0.25",
+        "level index=4 balls=2",
+        "benchmark id=update argument=5 cycles=123456",
+        "clock show_us=6700 drift_ms=-3",
+        "invariant broken=solid,speed ball=1 level=9 x=2.5 y=11.75",
+    ] + ["gesture kind=double-tap"] * 10 + [
+        # Two of the burst of twelve gestures didn't fit in the buffer
+        "timing micros=850 steps=1 mA=312 dropped=2",
+        "memory free=412 unused=300",
+    ]
+    expect(lines == expected, "decoded\n  %s\nexpected\n  %s" % ("\n  ".join(lines), "\n  ".join(expected)))
+    expect("corrupt frames skipped" in err, "corrupt frames weren't counted: %r" % err)
+
+    print("%d records through a pty, %s" % (len(records), err.strip()))
+    print("telemetry_test: %s (%d failures)" % ("FAILED" if failures else "ok", failures))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+#
+#   Copyright 2019 Zach Vonler
+#
+#   This file is part of LEDbyrinth.
+#
+#   LEDbyrinth is free software: you can redistribute it and/or modify
+#   it under the terms of the GNU General Public License as published by
+#   the Free Software Foundation, either version 3 of the License, or
+#   (at your option) any later version.
+#
+#   LEDbyrinth is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Writes the accelerometer traces that test/GestureTest replays.
+
+Usage: gesture_traces.py [DIRECTORY]
+
+Each trace is synthesized from a model of how the board moves: resting,
+hand tremor, a humming table, tilting play in several styles, and the
+gestures themselves. Every sample gets the same +-10 milli-g of noise as
+the accelerometer shows at rest. The traces are written to DIRECTORY,
+test/build/traces by default, where make check writes them, one file
+each:
+
+    # period 12
+    # expect shake 0 doubletap 0 still 0
+    x y z
+    ...
+
+with a sample every period millis, in milli-g, and the gestures the
+detector should recognize in the whole trace. Any more it recognizes are
+false positives. A trace recorded from a board can be added in the same
+format.
+"""
+
+import math
+import os
+import random
+import sys
+
+PERIOD = 0.012  # Seconds between samples, about one per update()
+
+
+def resting(t):
+    return 0, 0, 1000
+
+
+def tremor(t):
+    return 40 * math.sin(t * 50), 30 * math.sin(t * 37), 1000
+
+
+def tilted(a, b):
+    return 1000 * math.sin(a), 1000 * math.sin(b), 1000 * math.cos(a) * math.cos(b)
+
+
+def slow_tilts(t):
+    return tilted(0.5 * math.sin(t * 1.3) * math.sin(t * 0.31),
+                  0.5 * math.sin(t * 0.9 + 1) * math.sin(t * 0.23))
+
+
+def brisk_tilts(t):
+    return tilted(0.6 * math.sin(t * 6), 0.6 * math.sin(t * 4.7 + 1))
+
+
+def flick_tilts(t):
+    p = math.fmod(t, 1.7)
+    return tilted(0.7 * math.sin(p / 0.15 * math.pi) if p < 0.15 else 0, 0)
+
+
+def tap(p, start):
+    # A knuckle on the frame jolts it up to 3 g, the accelerometer's range,
+    # and the board rings at about 25 Hz, falling to a third every 15 ms
+    t = p - start
+    if t < 0:
+        return 0
+    return 3000 * math.exp(-t / 0.015) * math.cos(2 * math.pi * 25 * t)
+
+
+def double_taps(t):
+    p = math.fmod(t, 5)
+    return 0, 0, 1000 + tap(p, 1) + tap(p, 1.25)
+
+
+def single_taps(t):
+    return 0, 0, 1000 + tap(math.fmod(t, 2), 1)
+
+
+def shakes(t):
+    shaking = math.fmod(t, 10) < 1
+    return (1500 * math.sin(t * 40) if shaking else 0, 800 * math.sin(t * 33) if shaking else 0, 1000)
+
+
+def vibration(t):
+    # Left on a table by a running washing machine or a fan, which hums
+    # at about 50 Hz
+    return 40 * math.sin(t * 314), 30 * math.sin(t * 317 + 1), 1000 + 100 * math.sin(t * 311 + 2)
+
+
+def vibrating_tilts(t):
+    x, y, z = brisk_tilts(t)
+    hum = vibration(t)
+    return x + hum[0], y + hum[1], z + hum[2] - 1000
+
+
+def bumped_tilts(t):
+    # Knocks on the table or the frame while playing, never two in quick
+    # succession
+    x, y, z = slow_tilts(t)
+    return x, y, z + tap(math.fmod(t, 3.7), 2)
+
+
+def put_down(t):
+    # Played for half a minute, then left on the table
+    return brisk_tilts(t) if t < 30 else resting(t)
+
+
+# Name, model, seconds, shakes, double taps, times still
+TRACES = [
+    ("resting", resting, 120, 0, 0, 1),
+    ("tremor", tremor, 120, 0, 0, 0),
+    ("slow_tilts", slow_tilts, 120, 0, 0, 0),
+    ("brisk_tilts", brisk_tilts, 120, 0, 0, 0),
+    ("flick_tilts", flick_tilts, 120, 0, 0, 0),
+    ("vibration", vibration, 120, 0, 0, 0),
+    ("vibrating_tilts", vibrating_tilts, 120, 0, 0, 0),
+    ("bumped_tilts", bumped_tilts, 120, 0, 0, 0),
+    ("double_taps", double_taps, 60, 0, 12, 0),
+    ("single_taps", single_taps, 60, 0, 0, 0),
+    ("shakes", shakes, 60, 6, 0, 0),
+    ("put_down", put_down, 60, 0, 0, 1),
+]
+
+
+def main():
+    directory = sys.argv[1] if len(sys.argv) > 1 else os.path.join(
+        os.path.dirname(__file__), "..", "test", "build", "traces")
+    os.makedirs(directory, exist_ok=True)
+
+    for name, model, seconds, shake, doubletap, still in TRACES:
+        noise = random.Random(name)
+        with open(os.path.join(directory, name + ".txt"), "w") as f:
+            f.write("# period %d\n" % round(PERIOD * 1000))
+            f.write("# expect shake %d doubletap %d still %d\n" % (shake, doubletap, still))
+            for i in range(round(seconds / PERIOD)):
+                x, y, z = model(i * PERIOD)
+                f.write("%d %d %d\n" % tuple(round(v + noise.randint(-10, 10)) for v in (x, y, z)))
+
+
+if __name__ == "__main__":
+    main()
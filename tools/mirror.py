@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+#
+#   Copyright 2019 Zach Vonler
+#
+#   This file is part of LEDbyrinth.
+#
+#   LEDbyrinth is free software: you can redistribute it and/or modify
+#   it under the terms of the GNU General Public License as published by
+#   the Free Software Foundation, either version 3 of the License, or
+#   (at your option) any later version.
+#
+#   LEDbyrinth is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Shows the frames mirrored by FrameMirror.hpp in a terminal.
+
+Usage: mirror.py DEVICE [BAUD]
+
+DEVICE is a serial port, a pty or a file holding a captured stream, as for
+telemetry.py, so recorded sessions can be played back. The terminal needs
+24-bit color.
+"""
+
+import errno
+import os
+import sys
+
+import telemetry
+
+WIDTH = 17
+HEIGHT = 13
+
+# Gamma of the correction FrameMatrix.hpp applies
+GAMMA = 2.2
+
+
+def position(i):
+    """Returns the x, y of pixel i of the strip, which is wired in rows from
+    the top left, alternating direction."""
+    y, x = divmod(i, WIDTH)
+    return (WIDTH - 1 - x if y & 1 else x), y
+
+
+class Mirror:
+    """Rebuilds the matrix from pixel runs."""
+
+    def __init__(self):
+        self.channels = bytearray(WIDTH * HEIGHT * 3)
+        self.synced = False  # Every pixel has been received
+        self.frames = 0      # Frames rebuilt
+        self.first = None    # Number of the first frame rebuilt
+        self.shown = 0       # Frames shown on the LEDs since then
+        self.brightness = 255
+
+    def apply(self, name, fields):
+        """Applies a record. Returns true if it completed a frame."""
+        if name == "pixels":
+            start = fields["start"] * 3
+            data = bytes.fromhex(fields["channels"])
+            self.channels[start:start + len(data)] = data
+            return False
+        if name == "frame":
+            self.synced |= bool(fields["keyframe"])
+            self.frames += 1
+            if self.first is None:
+                self.first = fields["number"]
+            self.shown = (fields["number"] - self.first) & 0xFFFF
+            self.brightness = fields["brightness"]
+            return True
+        return False
+
+    def render(self):
+        """Returns the frame as terminal escapes, two columns per pixel."""
+        # The LEDs get the colors gamma corrected and scaled down by the
+        # brightness, so undo both for the screen
+        scale = 256.0 / 255 / (self.brightness + 1)
+        rows = [[None] * WIDTH for _ in range(HEIGHT)]
+        for i in range(WIDTH * HEIGHT):
+            g, r, b = (min(255, int(255 * (c * scale) ** (1 / GAMMA))) for c in self.channels[i * 3:i * 3 + 3])
+            x, y = position(i)
+            rows[y][x] = "\x1b[48;2;%d;%d;%dm  " % (r, g, b)
+        lines = ["".join(row) + "\x1b[0m" for row in rows]
+        status = "frame %d of %d shown%s" % (
+            self.frames, self.shown + 1, "" if self.synced else ", waiting for a keyframe")
+        return "\x1b[H" + "\n".join(lines) + "\n" + status + "\x1b[K\n"
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.exit(__doc__)
+    baud = int(argv[2]) if len(argv) > 2 else 115200
+    fd = telemetry.open_device(argv[1], baud)
+    decoder = telemetry.Decoder()
+    mirror = Mirror()
+    sys.stdout.write("\x1b[2J")
+    while True:
+        try:
+            data = os.read(fd, 256)
+        except OSError as e:
+            # A pty whose other end closed, or a port unplugged
+            if e.errno != errno.EIO:
+                raise
+            data = b""
+        if not data:
+            break
+        for name, fields in decoder.feed(data):
+            if mirror.apply(name, fields):
+                sys.stdout.write(mirror.render())
+                sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+#
+#   Copyright 2019 Zach Vonler
+#
+#   This file is part of LEDbyrinth.
+#
+#   LEDbyrinth is free software: you can redistribute it and/or modify
+#   it under the terms of the GNU General Public License as published by
+#   the Free Software Foundation, either version 3 of the License, or
+#   (at your option) any later version.
+#
+#   LEDbyrinth is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with LEDbyrinth.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Decodes the binary telemetry stream sent by Telemetry.hpp.
+
+Usage: telemetry.py DEVICE [BAUD]
+
+DEVICE is a serial port, a pty or a file holding a captured stream. Each
+record is printed as one line as it arrives.
+"""
+
+import errno
+import os
+import struct
+import sys
+import termios
+import tty
+
+SYNC = 0xA5
+VERSION = 1
+
+# 10 was the fuzzer's on the board, kept to read old captures
+RECORDS = {
+    1: ("ball", "<Bhhhh", ("index", "x", "y", "v_x", "v_y")),
+    2: ("level", "<BB", ("index", "balls")),
+    3: ("timing", "<HBHH", ("micros", "steps", "mA", "dropped")),
+    4: ("sensors", "<hh", ("x", "y")),
+    5: ("benchmark", "<BBI", ("id", "argument", "cycles")),
+    6: ("memory", "<HH", ("free", "unused")),
+    7: ("gesture", "<B", ("kind",)),
+    8: ("clock", "<Hi", ("show_us", "drift_ms")),
+    9: ("invariant", "<BBBhh", ("broken", "ball", "level", "x", "y")),
+    10: ("fuzz", "<BHBH", ("level", "seed", "segments", "step")),
+    11: ("transition", "<BBH", ("level", "prefetched", "gap_us")),
+    12: ("pixels", None, ("start", "channels")),
+    13: ("frame", "<HBB", ("number", "brightness", "keyframe")),
+    14: ("progress", "<BBBB", ("level", "traps", "writes", "written")),
+}
+
+# 4 was the screensaver, kept to read old captures
+BENCHMARKS = {1: "cellAt", 2: "update", 3: "redrawBoard", 4: "screensaver", 5: "maze", 6: "cellTraits", 7: "attract", 8: "balls",
+              9: "draw", 10: "brightness", 11: "mazeStep", 12: "tilt"}
+GESTURES = {1: "shake", 2: "double-tap", 3: "still"}
+INVARIANTS = {1: "bounds", 2: "solid", 4: "speed", 8: "occupancy"}
+
+# Fields sent as fixed point, and the scale that turns them back into units
+SCALES = {
+    ("ball", "x"): 256.0, ("ball", "y"): 256.0,
+    ("ball", "v_x"): 256.0, ("ball", "v_y"): 256.0,
+    ("sensors", "x"): 1000.0, ("sensors", "y"): 1000.0,
+    ("invariant", "x"): 256.0, ("invariant", "y"): 256.0,
+}
+
+
+def decode(type_, payload):
+    """Returns (name, {field: value}) for a record, or None if it's unknown."""
+    if type_ not in RECORDS:
+        return None
+    name, fmt, fields = RECORDS[type_]
+    if name == "pixels":
+        # A run of pixels, as many as the record holds
+        if len(payload) < 1 or (len(payload) - 1) % 3:
+            return None
+        return name, {"start": payload[0], "channels": payload[1:].hex()}
+    if struct.calcsize(fmt) != len(payload):
+        return None
+    values = struct.unpack(fmt, payload)
+    fields = {f: v / SCALES[name, f] if (name, f) in SCALES else v for f, v in zip(fields, values)}
+    if name == "benchmark":
+        fields["id"] = BENCHMARKS.get(values[0], values[0])
+    elif name == "gesture":
+        fields["kind"] = GESTURES.get(values[0], values[0])
+    elif name == "invariant":
+        fields["broken"] = ",".join(n for bit, n in sorted(INVARIANTS.items()) if values[0] & bit)
+    elif name == "fuzz":
+        fields["segments"] = format(values[2], "08b")
+    return name, fields
+
+
+class Decoder:
+    """Turns bytes into records, resynchronizing on corrupt frames."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.errors = 0
+
+    def feed(self, data):
+        self.buffer += data
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                self.buffer.clear()
+                return
+            del self.buffer[:start]
+            if len(self.buffer) < 4:
+                return
+            length = self.buffer[3]
+            if len(self.buffer) < length + 5:
+                return
+            frame = self.buffer[1:length + 5]
+            if sum(frame[:-1]) & 0xFF != frame[-1] or frame[0] != VERSION:
+                # Not a real frame, try the next sync byte
+                self.errors += 1
+                del self.buffer[0]
+                continue
+            del self.buffer[:length + 5]
+            record = decode(frame[1], bytes(frame[3:-1]))
+            if record:
+                yield record
+
+
+BAUDS = {9600: termios.B9600, 57600: termios.B57600, 115200: termios.B115200}
+
+
+def open_device(path, baud):
+    fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+    if os.isatty(fd):
+        tty.setraw(fd, termios.TCSANOW)  # Keeps bytes already received
+        attrs = termios.tcgetattr(fd)
+        attrs[4] = attrs[5] = BAUDS[baud]
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.exit(__doc__)
+    baud = int(argv[2]) if len(argv) > 2 else 115200
+    fd = open_device(argv[1], baud)
+    decoder = Decoder()
+    while True:
+        try:
+            data = os.read(fd, 256)
+        except OSError as e:
+            # A pty whose other end closed, or a port unplugged
+            if e.errno != errno.EIO:
+                raise
+            data = b""
+        if not data:
+            break
+        for name, fields in decoder.feed(data):
+            print(name, " ".join("%s=%s" % item for item in fields.items()), flush=True)
+    if decoder.errors:
+        print("%d corrupt frames skipped" % decoder.errors, file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main(sys.argv)